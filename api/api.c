@@ -496,7 +496,7 @@ static int API_env_enum(va_list ap)
 {
 	int i, buflen;
 	char *last, **next, *s;
-	ENTRY *match, search;
+	ENTRY *match;
 	static char *var;
 
 	last = (char *)va_arg(ap, unsigned long);
@@ -512,9 +512,9 @@ static int API_env_enum(va_list ap)
 		s = strchr(var, '=');
 		if (s != NULL)
 			*s = 0;
-		search.key = var;
-		i = hsearch_r(search, FIND, &match, &env_htab, 0);
-		if (i == 0) {
+		/* hmatch_r() counts in key order, so find the key's position */
+		i = hmatch_r(var, 0, &match, &env_htab);
+		if (i == 0 || strcmp(match->key, var)) {
 			i = API_EINVAL;
 			goto done;
 		}
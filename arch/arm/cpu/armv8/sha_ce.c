@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * SHA-1/SHA-256 engine using the ARMv8 Crypto Extensions
+ */
+
+#include <common.h>
+#include <u-boot/sha_engine.h>
+
+void sha1_ce_blocks(uint32_t state[5], const uint8_t *data, int blocks);
+void sha256_ce_blocks(uint32_t state[8], const uint8_t *data, int blocks);
+
+static u64 read_isar0(void)
+{
+	u64 val;
+
+	asm volatile("mrs %0, id_aa64isar0_el1" : "=r" (val));
+
+	return val;
+}
+
+/* ID_AA64ISAR0_EL1.SHA1 and .SHA2 are non-zero if the insns exist */
+#ifdef CONFIG_SHA1
+static bool sha1_ce_probe(void)
+{
+	return (read_isar0() >> 8) & 0xf;
+}
+
+U_BOOT_SHA_ENGINE(sha1_ce) = {
+	.name		= "armv8-ce",
+	.probe		= sha1_ce_probe,
+	.sha1_blocks	= sha1_ce_blocks,
+};
+#endif
+
+#ifdef CONFIG_SHA256
+static bool sha256_ce_probe(void)
+{
+	return (read_isar0() >> 12) & 0xf;
+}
+
+U_BOOT_SHA_ENGINE(sha256_ce) = {
+	.name		= "armv8-ce",
+	.probe		= sha256_ce_probe,
+	.sha256_blocks	= sha256_ce_blocks,
+};
+#endif
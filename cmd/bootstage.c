@@ -13,6 +13,16 @@ static int do_bootstage_report(cmd_tbl_t *cmdtp, int flag, int argc,
 	return 0;
 }
 
+#ifdef CONFIG_BOOTSTAGE_INITCALLS
+static int do_bootstage_initcalls(cmd_tbl_t *cmdtp, int flag, int argc,
+				  char * const argv[])
+{
+	bootstage_report_initcalls();
+
+	return 0;
+}
+#endif
+
 static int get_base_size(int argc, char * const argv[], ulong *basep,
 			 ulong *sizep)
 {
@@ -59,6 +69,9 @@ static int do_bootstage_stash(cmd_tbl_t *cmdtp, int flag, int argc,
 
 static cmd_tbl_t cmd_bootstage_sub[] = {
 	U_BOOT_CMD_MKENT(report, 2, 1, do_bootstage_report, "", ""),
+#ifdef CONFIG_BOOTSTAGE_INITCALLS
+	U_BOOT_CMD_MKENT(initcalls, 2, 1, do_bootstage_initcalls, "", ""),
+#endif
 	U_BOOT_CMD_MKENT(stash, 4, 0, do_bootstage_stash, "", ""),
 	U_BOOT_CMD_MKENT(unstash, 4, 0, do_bootstage_stash, "", ""),
 };
@@ -89,6 +102,9 @@ U_BOOT_CMD(bootstage, 4, 1, do_boostage,
 	"Boot stage command",
 	" - check boot progress and timing\n"
 	"report                      - Print a report\n"
+#ifdef CONFIG_BOOTSTAGE_INITCALLS
+	"initcalls                   - Print the time taken by init functions\n"
+#endif
 	"stash [<start> [<size>]]    - Stash data into memory\n"
 	"unstash [<start> [<size>]]  - Unstash data from memory"
 );
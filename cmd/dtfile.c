@@ -22,6 +22,9 @@ static int do_dtfile(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	int dtbo_num = 0;
 	char * dtparam_name[30],*dt_s;
 	char * dtparam_value[30];
+	void *fdtos[30];
+	int fdto_num = 0;
+	ulong fdto_addr;
 
 
 	dtoverlay_debug("param no:%d  %s  %s %s %s \n",argc,argv[1],argv[2],argv[3],argv[4]);
@@ -32,6 +35,7 @@ static int do_dtfile(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	dt_addr = simple_strtoul(argv[1], NULL, 16);
 
 	overlay_addr = simple_strtoul(argv[2], NULL, 16);
+	fdto_addr = overlay_addr;
 
 	env_file = argv[3];
 
@@ -156,10 +160,17 @@ static int do_dtfile(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 				}
 				if(NULL == overlay_name)
 					overlay_name = value;
-				if(value != NULL)
+				/*
+				 * Keep each overlay after the previous one so
+				 * that they can all be applied in one pass
+				 */
+				if(value != NULL && fdto_num < ARRAY_SIZE(fdtos))
 				{
-					edit_dtparam(overlay_addr,overlay_name,overlay_para_name,overlay_para_value,dtbo_num);
-					fdt_overlay_apply_verbose((void *)dt_addr, (void *)overlay_addr);
+					edit_dtparam(fdto_addr,overlay_name,overlay_para_name,overlay_para_value,dtbo_num);
+					if (!fdt_check_header((void *)fdto_addr)) {
+						fdtos[fdto_num++] = (void *)fdto_addr;
+						fdto_addr += ALIGN(fdt_totalsize((void *)fdto_addr), 8);
+					}
 				}
 			}
 		if (strncmp(dp, "#overlay_end",12) == 0) {
@@ -167,6 +178,9 @@ static int do_dtfile(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 			}
 		} while ((dp < data + size) && *dp);
 
+	if (fdto_num)
+		fdt_overlay_apply_list_verbose((void *)dt_addr, fdtos, fdto_num);
+
 	if(param_num != 0)
 	{
 		edit_dtparam(dt_addr," ",dtparam_name,dtparam_value,param_num);
@@ -177,7 +191,8 @@ static int do_dtfile(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 }
 
 static char dtfile_help_text[] =
-	"dtfile <dt addr> <overlays addr> <config name> <config addr>  - load the uEnv.txt to <fileaddr>\n";
+	"dtfile <dt addr> <overlays addr> <config name> <config addr>  - load the uEnv.txt to <fileaddr>\n"
+	"    the overlays are loaded one after another from <overlays addr>\n";
 
 U_BOOT_CMD(
 	dtfile,	255,	0,	do_dtfile,
@@ -652,25 +652,30 @@ static int do_fdt(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 
 	}
 #ifdef CONFIG_OF_LIBFDT_OVERLAY
-	/* apply an overlay */
+	/* apply overlays */
 	else if (strncmp(argv[1], "ap", 2) == 0) {
+		void *blobs[CONFIG_SYS_MAXARGS];
 		unsigned long addr;
 		struct fdt_header *blob;
-		int ret;
+		int ret, i;
 
-		if (argc != 3)
+		if (argc < 3)
 			return CMD_RET_USAGE;
 
 		if (!working_fdt)
 			return CMD_RET_FAILURE;
 
-		addr = simple_strtoul(argv[2], NULL, 16);
-		blob = map_sysmem(addr, 0);
-		if (!fdt_valid(&blob))
-			return CMD_RET_FAILURE;
+		for (i = 2; i < argc; i++) {
+			addr = simple_strtoul(argv[i], NULL, 16);
+			blob = map_sysmem(addr, 0);
+			if (!fdt_valid(&blob))
+				return CMD_RET_FAILURE;
+			blobs[i - 2] = blob;
+		}
 
 		/* apply method prints messages on error */
-		ret = fdt_overlay_apply_verbose(working_fdt, blob);
+		ret = fdt_overlay_apply_list_verbose(working_fdt, blobs,
+						     argc - 2);
 		if (ret)
 			return CMD_RET_FAILURE;
 	}
@@ -1071,7 +1076,7 @@ static int fdt_print(const char *pathp, char *prop, int depth)
 static char fdt_help_text[] =
 	"addr [-c]  <addr> [<length>]   - Set the [control] fdt location to <addr>\n"
 #ifdef CONFIG_OF_LIBFDT_OVERLAY
-	"fdt apply <addr>                    - Apply overlay to the DT\n"
+	"fdt apply <addr> [<addr>...]        - Apply overlays to the DT, in order\n"
 #endif
 #ifdef CONFIG_OF_BOARD_SETUP
 	"fdt boardsetup                      - Do board-specific set up\n"
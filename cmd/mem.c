@@ -16,6 +16,7 @@
 #include <cli.h>
 #include <command.h>
 #include <console.h>
+#include <div64.h>
 #include <hash.h>
 #include <mapmem.h>
 #include <watchdog.h>
@@ -947,6 +948,81 @@ static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 }
 #endif	/* CONFIG_CMD_MEMTEST */
 
+#ifdef CONFIG_CMD_MEMBENCH
+/* Print the throughput in MB/s of moving @bytes in @us microseconds */
+static void mem_bench_print(u64 bytes, ulong us)
+{
+	printf(" %8llu", lldiv(bytes, us ? us : 1));
+}
+
+/*
+ * Time memcpy(), memmove() and memset() for a range of block sizes. The
+ * memory at [addr, addr + 2 * len + 64) is overwritten: the first half is
+ * the source, also used for overlapping moves, the second the destination.
+ */
+static int do_mem_bench(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	static const ulong sizes[] = { 32, 128, 1024, 4096, 65536, 1 << 20 };
+	ulong addr, len, iterations = 16;
+	ulong start, copy_us, move_us, set_us;
+	ulong size, count, n;
+	char *src, *dst;
+	u64 bytes;
+	int i;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+
+	addr = simple_strtoul(argv[1], NULL, 16) + base_address;
+	len = simple_strtoul(argv[2], NULL, 16);
+	if (argc > 3)
+		iterations = simple_strtoul(argv[3], NULL, 10);
+	if (!len || !iterations)
+		return CMD_RET_USAGE;
+
+	src = map_sysmem(addr, 2 * len + 64);
+	dst = src + len + 64;
+	memset(src, 0xa5, len + 64);
+
+	puts("    size   memcpy  memmove   memset (MB/s)\n");
+	for (i = 0; ; i++) {
+		size = i < ARRAY_SIZE(sizes) ? min(sizes[i], len) : len;
+		/* move about the same amount of data for each block size */
+		count = max(len / size, 1UL) * iterations;
+		bytes = (u64)count * size;
+
+		start = timer_get_us();
+		for (n = 0; n < count; n++)
+			memcpy(dst, src, size);
+		copy_us = timer_get_us() - start;
+
+		start = timer_get_us();
+		for (n = 0; n < count; n++)
+			memmove(src + 8, src, size);
+		move_us = timer_get_us() - start;
+
+		start = timer_get_us();
+		for (n = 0; n < count; n++)
+			memset(dst, n, size);
+		set_us = timer_get_us() - start;
+
+		printf("%8lx", size);
+		mem_bench_print(bytes, copy_us);
+		mem_bench_print(bytes, move_us);
+		mem_bench_print(bytes, set_us);
+		putc('\n');
+
+		if (size == len || ctrlc())
+			break;
+	}
+
+	unmap_sysmem(src);
+
+	return 0;
+}
+#endif	/* CONFIG_CMD_MEMBENCH */
+
 /* Modify memory.
  *
  * Syntax:
@@ -1221,6 +1297,16 @@ U_BOOT_CMD(
 );
 #endif	/* CONFIG_CMD_MEMTEST */
 
+#ifdef CONFIG_CMD_MEMBENCH
+U_BOOT_CMD(
+	membench,	4,	1,	do_mem_bench,
+	"memcpy/memmove/memset throughput",
+	"address size [iterations]\n"
+	"    - time copies of increasing block sizes, up to 'size' bytes,\n"
+	"      using 2 * 'size' + 0x40 bytes of scratch memory at 'address'"
+);
+#endif	/* CONFIG_CMD_MEMBENCH */
+
 #ifdef CONFIG_MX_CYCLIC
 U_BOOT_CMD(
 	mdc,	4,	1,	do_mem_mdc,
@@ -323,6 +323,16 @@ static lbaint_t mmc_sparse_reserve(struct sparse_storage *info,
 	return blkcnt;
 }
 
+#ifdef CONFIG_IMAGE_SPARSE_ERASE
+static lbaint_t mmc_sparse_erase(struct sparse_storage *info,
+				 lbaint_t blk, lbaint_t blkcnt)
+{
+	struct blk_desc *dev_desc = info->priv;
+
+	return blk_derase(dev_desc, blk, blkcnt);
+}
+#endif
+
 static int do_mmc_sparse_write(cmd_tbl_t *cmdtp, int flag,
 			       int argc, char * const argv[])
 {
@@ -363,7 +373,14 @@ static int do_mmc_sparse_write(cmd_tbl_t *cmdtp, int flag,
 	sparse.size = dev_desc->lba - blk;
 	sparse.write = mmc_sparse_write;
 	sparse.reserve = mmc_sparse_reserve;
+	sparse.erase = NULL;
 	sparse.mssg = NULL;
+#ifdef CONFIG_IMAGE_SPARSE_ERASE
+	if (mmc_erase_is_zero(mmc)) {
+		sparse.erase = mmc_sparse_erase;
+		sparse.erase_blks = mmc->erase_grp_size;
+	}
+#endif
 	sprintf(dest, "0x" LBAF, sparse.start * sparse.blksz);
 
 	if (write_sparse_image(&sparse, dest, addr, NULL))
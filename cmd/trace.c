@@ -5,6 +5,7 @@
 
 #include <common.h>
 #include <command.h>
+#include <fs.h>
 #include <mapmem.h>
 #include <trace.h>
 #include <asm/io.h>
@@ -28,7 +29,19 @@ static int get_args(int argc, char * const argv[], char **buff,
 	return 0;
 }
 
-static int create_func_list(int argc, char * const argv[])
+/**
+ * Append a chunk of trace data to the output buffer
+ *
+ * @param argc	Number of command arguments
+ * @param argv	Command arguments, giving the buffer if not in the environment
+ * @param list	Function to write the chunk
+ * @param what	Description of the chunk
+ * @return 0 if ok, -1 if the arguments are invalid
+ */
+static int create_list(int argc, char * const argv[],
+		       int (*list)(void *buff, int buff_size,
+				   unsigned int *needed),
+		       const char *what)
 {
 	size_t buff_size, avail, buff_ptr, used;
 	unsigned int needed;
@@ -39,12 +52,13 @@ static int create_func_list(int argc, char * const argv[])
 		return -1;
 
 	avail = buff_size - buff_ptr;
-	err = trace_list_functions(buff + buff_ptr, avail, &needed);
+	err = list(buff + buff_ptr, avail, &needed);
 	if (err)
 		printf("Error: truncated (%#x bytes needed)\n", needed);
 	used = min(avail, (size_t)needed);
-	printf("Function trace dumped to %08lx, size %#zx\n",
+	printf("%s dumped to %08lx, size %#zx\n", what,
 	       (ulong)map_to_sysmem(buff + buff_ptr), used);
+
 	env_set_hex("profbase", map_to_sysmem(buff));
 	env_set_hex("profsize", buff_size);
 	env_set_hex("profoffset", buff_ptr + used);
@@ -52,27 +66,26 @@ static int create_func_list(int argc, char * const argv[])
 	return 0;
 }
 
-static int create_call_list(int argc, char * const argv[])
+/* Write the trace output buffer to a file */
+static int write_file(int argc, char * const argv[])
 {
-	size_t buff_size, avail, buff_ptr, used;
-	unsigned int needed;
-	char *buff;
-	int err;
+	ulong base, len;
+	loff_t actwrite;
 
-	if (get_args(argc, argv, &buff, &buff_ptr, &buff_size))
+	if (argc != 5)
 		return -1;
+	base = env_get_ulong("profbase", 16, 0);
+	len = env_get_ulong("profoffset", 16, 0);
+	if (!len) {
+		printf("No trace data to write\n");
+		return 1;
+	}
 
-	avail = buff_size - buff_ptr;
-	err = trace_list_calls(buff + buff_ptr, avail, &needed);
-	if (err)
-		printf("Error: truncated (%#x bytes needed)\n", needed);
-	used = min(avail, (size_t)needed);
-	printf("Call list dumped to %08lx, size %#zx\n",
-	       (ulong)map_to_sysmem(buff + buff_ptr), used);
-
-	env_set_hex("profbase", map_to_sysmem(buff));
-	env_set_hex("profsize", buff_size);
-	env_set_hex("profoffset", buff_ptr + used);
+	if (fs_set_blk_dev(argv[2], argv[3], FS_TYPE_ANY))
+		return 1;
+	if (fs_write(argv[4], base, 0, len, &actwrite))
+		return 1;
+	printf("%llu bytes written to %s\n", actwrite, argv[4]);
 
 	return 0;
 }
@@ -80,6 +93,7 @@ static int create_call_list(int argc, char * const argv[])
 int do_trace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	const char *cmd = argc < 2 ? NULL : argv[1];
+	int ret;
 
 	if (!cmd)
 		return cmd_usage(cmdtp);
@@ -88,19 +102,34 @@ int do_trace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 		trace_set_enabled(0);
 		break;
 	case 'c':
-		if (create_call_list(argc, argv))
+		if (create_list(argc, argv, trace_list_calls, "Call list"))
 			return cmd_usage(cmdtp);
 		break;
 	case 'r':
 		trace_set_enabled(1);
 		break;
 	case 'f':
-		if (create_func_list(argc, argv))
+		if (create_list(argc, argv, trace_list_functions,
+				"Function trace"))
 			return cmd_usage(cmdtp);
 		break;
+#ifdef CONFIG_BOOTSTAGE
+	case 'b':
+		if (create_list(argc, argv, bootstage_list_stages,
+				"Bootstage list"))
+			return cmd_usage(cmdtp);
+		break;
+#endif
 	case 's':
 		trace_print_stats();
 		break;
+	case 'w':
+		ret = write_file(argc, argv);
+		if (ret < 0)
+			return CMD_RET_USAGE;
+		if (ret)
+			return CMD_RET_FAILURE;
+		break;
 	default:
 		return CMD_RET_USAGE;
 	}
@@ -109,12 +138,18 @@ int do_trace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 }
 
 U_BOOT_CMD(
-	trace,	4,	1,	do_trace,
+	trace,	5,	1,	do_trace,
 	"trace utility commands",
 	"stats                        - display tracing statistics\n"
 	"trace pause                        - pause tracing\n"
 	"trace resume                       - resume tracing\n"
 	"trace funclist [<addr> <size>]     - dump function list into buffer\n"
 	"trace calls  [<addr> <size>]       "
-		"- dump function call trace into buffer"
+		"- dump function call trace into buffer\n"
+#ifdef CONFIG_BOOTSTAGE
+	"trace bootstage [<addr> <size>]    "
+		"- dump bootstage records into buffer\n"
+#endif
+	"trace write <interface> <dev[:part]> <filename>\n"
+	"                                   - write buffer to a file"
 );
@@ -10,8 +10,11 @@
  */
 
 #include <common.h>
+#include <fdt_support.h>
 #include <linux/libfdt.h>
 #include <malloc.h>
+#include <trace.h>
+#include <asm/sections.h>
 #include <linux/compiler.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -28,10 +31,21 @@ struct bootstage_record {
 	enum bootstage_id id;
 };
 
+/* Time taken by a function called by initcall_run_list() */
+struct bootstage_initcall {
+	ulong addr;		/* link-time address of the function */
+	uint32_t start_us;
+	uint32_t time_us;
+};
+
 struct bootstage_data {
 	uint rec_count;
 	uint next_id;
 	struct bootstage_record record[RECORD_COUNT];
+#if CONFIG_IS_ENABLED(BOOTSTAGE_INITCALLS)
+	uint initcall_count;	/* number of calls, may exceed the table */
+	struct bootstage_initcall initcall[CONFIG_BOOTSTAGE_INITCALL_COUNT];
+#endif
 };
 
 enum {
@@ -239,6 +253,184 @@ static int h_compare_record(const void *r1, const void *r2)
 	return rec1->time_us > rec2->time_us ? 1 : -1;
 }
 
+#if CONFIG_IS_ENABLED(BOOTSTAGE_INITCALLS)
+void bootstage_initcall(ulong addr, uint32_t start_us, uint32_t time_us)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_initcall *call;
+
+	if (!data)
+		return;
+	if (data->initcall_count < CONFIG_BOOTSTAGE_INITCALL_COUNT) {
+		call = &data->initcall[data->initcall_count];
+		call->addr = addr;
+		call->start_us = start_us;
+		call->time_us = time_us;
+	}
+	data->initcall_count++;
+}
+
+static int h_compare_initcall(const void *c1, const void *c2)
+{
+	const struct bootstage_initcall *call1 = c1, *call2 = c2;
+
+	return call1->time_us < call2->time_us ? 1 : -1;
+}
+
+/**
+ * Sort the init function timings, slowest first
+ *
+ * @param data	Bootstage data
+ * @return number of timings recorded
+ */
+static uint sort_initcalls(struct bootstage_data *data)
+{
+	uint count = min_t(uint, data->initcall_count,
+			   CONFIG_BOOTSTAGE_INITCALL_COUNT);
+
+	qsort(data->initcall, count, sizeof(*data->initcall),
+	      h_compare_initcall);
+
+	return count;
+}
+
+static const char *get_initcall_name(char *buf, int len,
+				     const struct bootstage_initcall *call)
+{
+	snprintf(buf, len, "initcall %#lx", call->addr);
+
+	return buf;
+}
+
+void bootstage_report_initcalls(void)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_initcall *call;
+	ulong total = 0;
+	char buf[30];
+	uint count;
+	int i;
+
+	count = sort_initcalls(data);
+	printf("Init function time in microseconds (%u calls):\n", count);
+	printf("%11s  %s\n", "Elapsed", "Function");
+	for (i = 0, call = data->initcall; i < count; i++, call++) {
+		print_grouped_ull(call->time_us, BOOTSTAGE_DIGITS);
+		printf("  %s\n", get_initcall_name(buf, sizeof(buf), call));
+		total += call->time_us;
+	}
+	print_grouped_ull(total, BOOTSTAGE_DIGITS);
+	puts("  total\n");
+	if (data->initcall_count > count)
+		printf("Overflowed init function table by %u entries\n"
+		       "Please increase CONFIG_BOOTSTAGE_INITCALL_COUNT\n",
+		       data->initcall_count - count);
+}
+#endif
+
+/**
+ * Write a bootstage record for the profile output, if there is space
+ *
+ * @param ptrp	Pointer to buffer, updated by this function
+ * @param end	Pointer to end of buffer
+ * @param name	Name of record
+ * @param flags	Flags (TRACE_STAGEF_...)
+ * @param start_us	Start time in microseconds
+ * @param time_us	Time taken in microseconds, 0 for a mark
+ * @param func	Function offset into code, for an init function
+ * @return 1 if written, 0 if there was no space
+ */
+static int append_stage(void **ptrp, void *end, const char *name, uint flags,
+			uint32_t start_us, uint32_t time_us, uint32_t func)
+{
+	struct trace_output_stage *out = *ptrp;
+
+	*ptrp += sizeof(*out);
+	if (*ptrp > end)
+		return 0;
+
+	memset(out, '\0', sizeof(*out));
+	out->start_us = start_us;
+	out->time_us = time_us;
+	out->flags = flags;
+	out->func = func;
+	strlcpy(out->name, name, sizeof(out->name));
+
+	return 1;
+}
+
+int bootstage_list_stages(void *buff, int buff_size, unsigned int *needed)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct trace_output_hdr *output_hdr = NULL;
+	struct bootstage_record *rec;
+	void *end, *ptr = buff;
+	const char *name;
+	char buf[30];
+	uint flags;
+	int upto;
+	int i;
+
+	end = buff ? buff + buff_size : NULL;
+
+	/* Place some header information */
+	if (ptr + sizeof(struct trace_output_hdr) <= end)
+		output_hdr = ptr;
+	ptr += sizeof(struct trace_output_hdr);
+
+	for (i = upto = 0, rec = data->record; i < data->rec_count;
+	     i++, rec++) {
+		if (!rec->id)
+			continue;
+		name = get_record_name(buf, sizeof(buf), rec);
+		flags = rec->flags & BOOTSTAGEF_ERROR ? TRACE_STAGEF_ERROR : 0;
+		if (rec->start_us)
+			upto += append_stage(&ptr, end, name,
+					     flags | TRACE_STAGEF_ACCUM,
+					     rec->start_us, rec->time_us, 0);
+		else
+			upto += append_stage(&ptr, end, name, flags,
+					     rec->time_us, 0, 0);
+	}
+
+#if CONFIG_IS_ENABLED(BOOTSTAGE_INITCALLS)
+	for (i = 0; i < min_t(uint, data->initcall_count,
+			      CONFIG_BOOTSTAGE_INITCALL_COUNT); i++) {
+		struct bootstage_initcall *call = &data->initcall[i];
+		ulong func = call->addr;
+
+		/*
+		 * call->addr is a link-time address, so take it from the
+		 * link-time start of the code. This gives the same offset as
+		 * the function trace works out from gd->relocaddr, which is
+		 * also rounded down to FUNC_SITE_SIZE.
+		 */
+#ifdef CONFIG_SANDBOX
+		func -= (ulong)&_init;
+#elif defined(CONFIG_SYS_TEXT_BASE)
+		func -= CONFIG_SYS_TEXT_BASE;
+#endif
+		func = func / FUNC_SITE_SIZE * FUNC_SITE_SIZE;
+		name = get_initcall_name(buf, sizeof(buf), call);
+		upto += append_stage(&ptr, end, name, TRACE_STAGEF_INITCALL,
+				     call->start_us, call->time_us, func);
+	}
+#endif
+
+	/* Update the header */
+	if (output_hdr) {
+		output_hdr->rec_count = upto;
+		output_hdr->type = TRACE_CHUNK_STAGES;
+	}
+
+	/* Work out how much of the buffer we used */
+	*needed = ptr - buff;
+	if (ptr > end)
+		return -ENOSPC;
+
+	return 0;
+}
+
 #ifdef CONFIG_OF_LIBFDT
 /**
  * Add all bootstage timings to a device tree.
@@ -295,10 +487,61 @@ static int add_bootstages_devicetree(struct fdt_header *blob)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(BOOTSTAGE_INITCALLS)
+/**
+ * Add the init function timings to a device tree
+ *
+ * These go in a 'bootstage-initcalls' node under /chosen, with a child for
+ * each function, slowest first.
+ *
+ * @param blob	Device tree blob
+ * @return 0 on success, != 0 on failure.
+ */
+static int add_initcalls_devicetree(struct fdt_header *blob)
+{
+	struct bootstage_data *data = gd->bootstage;
+	int chosen, initcalls;
+	char buf[30];
+	int i;
+
+	if (!blob)
+		return 0;
+
+	chosen = fdt_find_or_add_subnode(blob, 0, "chosen");
+	if (chosen < 0)
+		return -EINVAL;
+	initcalls = fdt_add_subnode(blob, chosen, "bootstage-initcalls");
+	if (initcalls < 0)
+		return -EINVAL;
+
+	/* New nodes go first, so add them in reverse order */
+	for (i = sort_initcalls(data) - 1; i >= 0; i--) {
+		struct bootstage_initcall *call = &data->initcall[i];
+		int node;
+
+		node = fdt_add_subnode(blob, initcalls, simple_itoa(i));
+		if (node < 0)
+			return -EINVAL;
+
+		if (fdt_setprop_string(blob, node, "name",
+				       get_initcall_name(buf, sizeof(buf), call)))
+			return -EINVAL;
+		if (fdt_setprop_cell(blob, node, "accum", call->time_us))
+			return -EINVAL;
+	}
+
+	return 0;
+}
+#endif
+
 int bootstage_fdt_add_report(void)
 {
 	if (add_bootstages_devicetree(working_fdt))
 		puts("bootstage: Failed to add to device tree\n");
+#if CONFIG_IS_ENABLED(BOOTSTAGE_INITCALLS)
+	if (add_initcalls_devicetree(working_fdt))
+		puts("bootstage: Failed to add initcalls to device tree\n");
+#endif
 
 	return 0;
 }
@@ -1733,6 +1733,21 @@ int fdt_fixup_display(void *blob, const char *path, const char *display)
  * in the case of an error
  */
 int fdt_overlay_apply_verbose(void *fdt, void *fdto)
+{
+	return fdt_overlay_apply_list_verbose(fdt, &fdto, 1);
+}
+
+/**
+ * fdt_overlay_apply_list_verbose - Apply overlays with verbose error reporting
+ *
+ * @fdt: ptr to device tree, which must have room for all the overlays
+ * @fdtos: ptrs to device tree overlays, applied in order
+ * @count: number of overlays
+ *
+ * Convenience function to apply a list of overlays and display helpful
+ * messages in the case of an error
+ */
+int fdt_overlay_apply_list_verbose(void *fdt, void * const fdtos[], int count)
 {
 	int err;
 	bool has_symbols;
@@ -1740,7 +1755,10 @@ int fdt_overlay_apply_verbose(void *fdt, void *fdto)
 	err = fdt_path_offset(fdt, "/__symbols__");
 	has_symbols = err >= 0;
 
-	err = fdt_overlay_apply(fdt, fdto);
+	if (count == 1)
+		err = fdt_overlay_apply(fdt, fdtos[0]);
+	else
+		err = fdt_overlay_apply_list(fdt, fdtos, count);
 	if (err < 0) {
 		printf("failed on fdt_overlay_apply(): %s\n",
 				fdt_strerror(err));
@@ -1153,8 +1153,116 @@ int calculate_hash(const void *data, int data_len, const char *algo,
 	return 0;
 }
 
+enum {
+	FIT_STREAM_CRC32,
+	FIT_STREAM_SHA1,
+	FIT_STREAM_SHA256,
+};
+
+int fit_image_hash_stream_init(struct fit_hash_stream *st, const void *fit,
+			       int image_noffset)
+{
+	int noffset;
+	char *algo;
+	int ignore;
+
+	st->fit = fit;
+	st->image_noffset = image_noffset;
+	st->count = 0;
+
+	fdt_for_each_subnode(noffset, fit, image_noffset) {
+		const char *name = fit_get_name(fit, noffset, NULL);
+
+		if (strncmp(name, FIT_HASH_NODENAME,
+			    strlen(FIT_HASH_NODENAME)))
+			continue;
+
+		/* Leave errors to be reported by fit_image_check_hash() */
+		if (fit_image_hash_get_algo(fit, noffset, &algo))
+			continue;
+		if (IMAGE_ENABLE_IGNORE) {
+			fit_image_hash_get_ignore(fit, noffset, &ignore);
+			if (ignore)
+				continue;
+		}
+
+		if (st->count == FIT_STREAM_MAX_HASHES)
+			return -ENOSPC;
+
+		if (IMAGE_ENABLE_CRC32 && strcmp(algo, "crc32") == 0) {
+			st->hash[st->count].algo = FIT_STREAM_CRC32;
+			st->hash[st->count].ctx.crc32 = 0;
+		} else if (IMAGE_ENABLE_SHA1 && strcmp(algo, "sha1") == 0) {
+			st->hash[st->count].algo = FIT_STREAM_SHA1;
+			sha1_starts(&st->hash[st->count].ctx.sha1);
+		} else if (IMAGE_ENABLE_SHA256 && strcmp(algo, "sha256") == 0) {
+			st->hash[st->count].algo = FIT_STREAM_SHA256;
+			sha256_starts(&st->hash[st->count].ctx.sha256);
+		} else {
+			return -EPROTONOSUPPORT;
+		}
+		st->hash[st->count++].noffset = noffset;
+	}
+
+	return 0;
+}
+
+void fit_image_hash_stream_update(struct fit_hash_stream *st,
+				  const void *data, size_t size)
+{
+	int i;
+
+	for (i = 0; i < st->count; i++) {
+		int algo = st->hash[i].algo;
+
+		if (IMAGE_ENABLE_CRC32 && algo == FIT_STREAM_CRC32)
+			st->hash[i].ctx.crc32 = crc32(st->hash[i].ctx.crc32,
+						      data, size);
+		else if (IMAGE_ENABLE_SHA1 && algo == FIT_STREAM_SHA1)
+			sha1_update(&st->hash[i].ctx.sha1, data, size);
+		else if (IMAGE_ENABLE_SHA256 && algo == FIT_STREAM_SHA256)
+			sha256_update(&st->hash[i].ctx.sha256, data, size);
+	}
+}
+
+static int fit_image_hash_stream_finish(struct fit_hash_stream *st,
+					int noffset, uint8_t *value,
+					int *value_len)
+{
+	int i;
+
+	for (i = 0; i < st->count; i++) {
+		int algo = st->hash[i].algo;
+
+		if (st->hash[i].noffset != noffset)
+			continue;
+
+		if (IMAGE_ENABLE_CRC32 && algo == FIT_STREAM_CRC32) {
+			*((uint32_t *)value) =
+				cpu_to_uimage(st->hash[i].ctx.crc32);
+			*value_len = 4;
+		} else if (IMAGE_ENABLE_SHA1 && algo == FIT_STREAM_SHA1) {
+			sha1_finish(&st->hash[i].ctx.sha1, value);
+			*value_len = 20;
+		} else if (IMAGE_ENABLE_SHA256 && algo == FIT_STREAM_SHA256) {
+			sha256_finish(&st->hash[i].ctx.sha256, value);
+			*value_len = SHA256_SUM_LEN;
+		} else {
+			break;
+		}
+		return 0;
+	}
+
+	return -1;
+}
+
+/*
+ * Check one hash node, either by hashing @data or, if @st is not NULL, by
+ * taking the hash already calculated by the stream.
+ */
 static int fit_image_check_hash(const void *fit, int noffset, const void *data,
-				size_t size, char **err_msgp)
+				size_t size, struct fit_hash_stream *st,
+				char **err_msgp)
 {
 	uint8_t value[FIT_MAX_HASH_LEN];
 	int value_len;
@@ -1185,7 +1293,13 @@ static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 		return -1;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	if (st) {
+		if (fit_image_hash_stream_finish(st, noffset, value,
+						 &value_len)) {
+			*err_msgp = "Unsupported hash algorithm";
+			return -1;
+		}
+	} else if (calculate_hash(data, size, algo, value, &value_len)) {
 		*err_msgp = "Unsupported hash algorithm";
 		return -1;
 	}
@@ -1201,8 +1315,9 @@ static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 	return 0;
 }
 
-int fit_image_verify_with_data(const void *fit, int image_noffset,
-			       const void *data, size_t size)
+static int fit_image_verify_data(const void *fit, int image_noffset,
+				 const void *data, size_t size,
+				 struct fit_hash_stream *st)
 {
 	int		noffset = 0;
 	char		*err_msg = "";
@@ -1228,7 +1343,7 @@ int fit_image_verify_with_data(const void *fit, int image_noffset,
 		 */
 		if (!strncmp(name, FIT_HASH_NODENAME,
 			     strlen(FIT_HASH_NODENAME))) {
-			if (fit_image_check_hash(fit, noffset, data, size,
+			if (fit_image_check_hash(fit, noffset, data, size, st,
 						 &err_msg))
 				goto error;
 			puts("+ ");
@@ -1265,6 +1380,19 @@ error:
 	return 0;
 }
 
+int fit_image_verify_with_data(const void *fit, int image_noffset,
+			       const void *data, size_t size)
+{
+	return fit_image_verify_data(fit, image_noffset, data, size, NULL);
+}
+
+int fit_image_verify_stream(struct fit_hash_stream *st, const void *data,
+			    size_t size)
+{
+	return fit_image_verify_data(st->fit, st->image_noffset, data, size,
+				     st);
+}
+
 /**
  * fit_image_verify - verify data integrity
  * @fit: pointer to the FIT format image header
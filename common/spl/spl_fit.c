@@ -8,13 +8,131 @@
 #include <errno.h>
 #include <fpga.h>
 #include <image.h>
-#include <linux/libfdt.h>
+#include <lz4.h>
+#include <malloc.h>
+#include <memalign.h>
 #include <spl.h>
+#include <linux/libfdt.h>
+#include <lzma/LzmaTools.h>
+#include <u-boot/zlib.h>
 
 #ifndef CONFIG_SYS_BOOTM_LEN
 #define CONFIG_SYS_BOOTM_LEN	(64 << 20)
 #endif
 
+/* Amount of external image data read and hashed at a time */
+#define SPL_FIT_STREAM_SIZE	(64 << 10)
+
+/* Whether SPL can decompress images with compression type @comp */
+static bool spl_fit_decomp_supported(int comp)
+{
+	return (IS_ENABLED(CONFIG_SPL_GZIP) && comp == IH_COMP_GZIP) ||
+	       (IS_ENABLED(CONFIG_SPL_LZ4) && comp == IH_COMP_LZ4) ||
+	       (IS_ENABLED(CONFIG_SPL_LZMA) && comp == IH_COMP_LZMA) ||
+	       (IS_ENABLED(CONFIG_SPL_ZSTD) && comp == IH_COMP_ZSTD);
+}
+
+/* Whether SPL can decompress @comp images while they are being read */
+static bool spl_fit_decomp_stream_supported(int comp)
+{
+	return (IS_ENABLED(CONFIG_SPL_GZIP) && comp == IH_COMP_GZIP) ||
+	       (IS_ENABLED(CONFIG_SPL_LZ4) && comp == IH_COMP_LZ4) ||
+	       (IS_ENABLED(CONFIG_SPL_LZMA) && comp == IH_COMP_LZMA);
+}
+
+/**
+ * struct spl_fit_decomp - state of a decompression fed in chunks
+ *
+ * @comp:	Compression type (IH_COMP_...)
+ * @done:	true once the end of a gzip stream has been seen
+ * @zs:		zlib state, for IH_COMP_GZIP
+ * @lz4:	LZ4 frame state, for IH_COMP_LZ4
+ * @lzma:	LZMA state, for IH_COMP_LZMA
+ */
+struct spl_fit_decomp {
+	int comp;
+	bool done;
+	union {
+		z_stream zs;
+		struct ulz4_stream lz4;
+		struct lzma_stream lzma;
+	};
+};
+
+static int spl_fit_decomp_init(struct spl_fit_decomp *d, int comp, void *dst,
+			       size_t size)
+{
+	memset(d, '\0', sizeof(*d));
+	d->comp = comp;
+
+	if (IS_ENABLED(CONFIG_SPL_GZIP) && comp == IH_COMP_GZIP) {
+		d->zs.zalloc = gzalloc;
+		d->zs.zfree = gzfree;
+		d->zs.next_out = dst;
+		d->zs.avail_out = size;
+		/* Let zlib parse the gzip header and check the trailer */
+		if (inflateInit2(&d->zs, 16 + MAX_WBITS) != Z_OK)
+			return -ENOMEM;
+	} else if (IS_ENABLED(CONFIG_SPL_LZ4) && comp == IH_COMP_LZ4) {
+		ulz4_stream_init(&d->lz4, dst, size);
+	} else if (IS_ENABLED(CONFIG_SPL_LZMA) && comp == IH_COMP_LZMA) {
+		lzma_stream_init(&d->lzma, dst, size);
+	} else {
+		return -EPROTONOSUPPORT;
+	}
+
+	return 0;
+}
+
+static int spl_fit_decomp_feed(struct spl_fit_decomp *d, void *src,
+			       size_t len)
+{
+	int ret;
+
+	if (IS_ENABLED(CONFIG_SPL_GZIP) && d->comp == IH_COMP_GZIP) {
+		if (d->done)
+			return 0;
+		d->zs.next_in = src;
+		d->zs.avail_in = len;
+		ret = inflate(&d->zs, Z_SYNC_FLUSH);
+		if (ret == Z_STREAM_END)
+			d->done = true;
+		else if (ret != Z_OK && ret != Z_BUF_ERROR)
+			return -EIO;
+		else if (d->zs.avail_in)
+			return -ENOSPC;
+	} else if (IS_ENABLED(CONFIG_SPL_LZ4) && d->comp == IH_COMP_LZ4) {
+		return ulz4_stream_feed(&d->lz4, src, len);
+	} else if (IS_ENABLED(CONFIG_SPL_LZMA) && d->comp == IH_COMP_LZMA) {
+		if (lzma_stream_feed(&d->lzma, src, len) != SZ_OK)
+			return -EIO;
+	}
+
+	return 0;
+}
+
+/* Complete the decompression, returning the uncompressed size in @sizep */
+static int spl_fit_decomp_finish(struct spl_fit_decomp *d, size_t *sizep)
+{
+	SizeT size;
+	int ret = 0;
+
+	if (IS_ENABLED(CONFIG_SPL_GZIP) && d->comp == IH_COMP_GZIP) {
+		*sizep = d->zs.total_out;
+		if (!d->done)
+			ret = -EIO;
+		inflateEnd(&d->zs);
+	} else if (IS_ENABLED(CONFIG_SPL_LZ4) && d->comp == IH_COMP_LZ4) {
+		ret = ulz4_stream_finish(&d->lz4, sizep);
+	} else if (IS_ENABLED(CONFIG_SPL_LZMA) && d->comp == IH_COMP_LZMA) {
+		if (lzma_stream_finish(&d->lzma, &size) != SZ_OK)
+			ret = -EIO;
+		*sizep = size;
+	}
+
+	return ret;
+}
+
 /**
  * spl_fit_get_image_name(): By using the matching configuration subnode,
  * retrieve the name of an image, specified by a property name and an index
@@ -141,6 +259,152 @@ static int get_aligned_image_size(struct spl_load_info *info, int data_size,
 	return (data_size + info->bl_len - 1) / info->bl_len;
 }
 
+/**
+ * spl_load_fit_image_stream(): load and verify external image data in chunks
+ * @info:	points to information about the device to load data from
+ * @sector:	the start sector of the FIT image on the device
+ * @fit:	points to the flattened device tree blob describing the FIT
+ *		image
+ * @node:	offset of the DT node describing the image to load
+ * @offset:	offset of the image data from the start of the FIT
+ * @length:	size of the image data
+ * @load_addr:	address to load the image data to
+ *
+ * Each chunk is hashed and moved down to its place at @load_addr right
+ * after it has been read, while it is still in the cache, instead of going
+ * over the whole image again for each step once it has been read.
+ *
+ * Return:	0 on success, -ENOSPC or -EPROTONOSUPPORT if the image hashes
+ *		cannot be calculated this way, or another negative error number
+ */
+static int spl_load_fit_image_stream(struct spl_load_info *info, ulong sector,
+				     void *fit, int node, int offset,
+				     size_t length, ulong load_addr)
+{
+	struct fit_hash_stream st;
+	ulong load_ptr = ALIGN(load_addr, ARCH_DMA_MINALIGN);
+	ulong start = sector + get_aligned_image_offset(info, offset);
+	int overhead = get_aligned_image_overhead(info, offset);
+	int count = get_aligned_image_size(info, length, offset);
+	int unit = info->filename ? 1 : info->bl_len;
+	int chunk = max(SPL_FIT_STREAM_SIZE / unit, 1);
+	size_t done = 0, size;
+	void *src, *dst;
+	int pos, nr;
+	int ret;
+
+	ret = fit_image_hash_stream_init(&st, fit, node);
+	if (ret)
+		return ret;
+
+	printf("## Checking hash(es) for Image %s ... ",
+	       fit_get_name(fit, node, NULL));
+
+	for (pos = 0; pos < count; pos += nr) {
+		nr = min(count - pos, chunk);
+		if (info->read(info, start + pos, nr,
+			       (void *)load_ptr + pos * unit) != nr)
+			return -EIO;
+
+		/* Image data which has now been read, not yet in place */
+		size = min_t(size_t, (pos + nr) * unit - overhead, length);
+		size -= done;
+		src = (void *)load_ptr + overhead + done;
+		dst = (void *)load_addr + done;
+
+		fit_image_hash_stream_update(&st, src, size);
+		if (src != dst)
+			memmove(dst, src, size);
+		done += size;
+	}
+
+	debug("Streamed data: dst=%lx, offset=%x, size=%lx\n",
+	      load_addr, offset, (unsigned long)length);
+
+	if (!fit_image_verify_stream(&st, (void *)load_addr, length))
+		return -EPERM;
+	puts("OK\n");
+
+	return 0;
+}
+
+/**
+ * spl_load_fit_image_decomp(): load and decompress external image data in
+ * chunks
+ * @info:	points to information about the device to load data from
+ * @sector:	the start sector of the FIT image on the device
+ * @offset:	offset of the image data from the start of the FIT
+ * @length:	size of the (compressed) image data
+ * @comp:	compression type of the image data (IH_COMP_...)
+ * @load_addr:	address to decompress the image data to
+ * @sizep:	returns the size of the decompressed data
+ *
+ * Each chunk is decompressed to @load_addr as soon as it has been read, so
+ * only one chunk of the compressed data is ever held in memory.
+ *
+ * Return:	0 on success, -ENOMEM if there is no room for the chunk
+ *		buffer or the decompressor's buffers, or another negative
+ *		error number
+ */
+static int spl_load_fit_image_decomp(struct spl_load_info *info, ulong sector,
+				     int offset, size_t length, int comp,
+				     ulong load_addr, size_t *sizep)
+{
+	struct spl_fit_decomp d;
+	ulong start = sector + get_aligned_image_offset(info, offset);
+	int overhead = get_aligned_image_overhead(info, offset);
+	int count = get_aligned_image_size(info, length, offset);
+	int unit = info->filename ? 1 : info->bl_len;
+	int chunk = max(SPL_FIT_STREAM_SIZE / unit, 1);
+	size_t done = 0, size;
+	void *buf;
+	int pos, nr;
+	int ret, err;
+
+	buf = malloc_cache_aligned(chunk * unit);
+	if (!buf)
+		return -ENOMEM;
+
+	ret = spl_fit_decomp_init(&d, comp, (void *)load_addr,
+				  CONFIG_SYS_BOOTM_LEN);
+	if (ret)
+		goto out;
+
+	for (pos = 0; pos < count; pos += nr) {
+		nr = min(count - pos, chunk);
+		if (info->read(info, start + pos, nr, buf) != nr) {
+			ret = -EIO;
+			break;
+		}
+
+		/* Image data in this chunk, skipping any alignment overhead */
+		size = min_t(size_t, (pos + nr) * unit - overhead, length);
+		size -= done;
+		ret = spl_fit_decomp_feed(&d, buf + overhead + done -
+					  pos * unit, size);
+		if (ret) {
+			/* The caller falls back to the staged path on -ENOMEM */
+			if (ret != -ENOMEM)
+				puts("Uncompressing error\n");
+			break;
+		}
+		done += size;
+	}
+
+	err = spl_fit_decomp_finish(&d, sizep);
+	if (!ret && err) {
+		puts("Uncompressing error\n");
+		ret = err;
+	}
+
+	debug("Decompressed data: dst=%lx, offset=%x, size=%lx\n",
+	      load_addr, offset, (unsigned long)*sizep);
+out:
+	free(buf);
+
+	return ret;
+}
+
 /**
  * spl_load_fit_image(): load the image described in a certain FIT node
  * @info:	points to information about the device to load data from
@@ -174,6 +438,7 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 	uint8_t image_comp = -1, type = -1;
 	const void *data;
 	bool external_data = false;
+	int ret;
 
 	if (IS_ENABLED(CONFIG_SPL_FPGA_SUPPORT) ||
 	    (IS_ENABLED(CONFIG_SPL_OS_BOOT) && IS_ENABLED(CONFIG_SPL_GZIP))) {
@@ -183,7 +448,8 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 			debug("%s ", genimg_get_type_name(type));
 	}
 
-	if (IS_ENABLED(CONFIG_SPL_OS_BOOT) && IS_ENABLED(CONFIG_SPL_GZIP)) {
+	if (IS_ENABLED(CONFIG_SPL_GZIP) || IS_ENABLED(CONFIG_SPL_LZ4) ||
+	    IS_ENABLED(CONFIG_SPL_LZMA) || IS_ENABLED(CONFIG_SPL_ZSTD)) {
 		if (fit_image_get_comp(fit, node, &image_comp))
 			puts("Cannot get image compression format.\n");
 		else
@@ -205,7 +471,46 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 		if (fit_image_get_data_size(fit, node, &len))
 			return -ENOENT;
 
+		/*
+		 * Data which only needs to be verified and put in place can
+		 * be hashed as it is read
+		 */
+		if (IS_ENABLED(CONFIG_SPL_FIT_SIGNATURE) &&
+		    !IS_ENABLED(CONFIG_SPL_FIT_IMAGE_POST_PROCESS) &&
+		    !spl_fit_decomp_supported(image_comp)) {
+			ret = spl_load_fit_image_stream(info, sector, fit,
+							node, offset, len,
+							load_addr);
+			if (!ret) {
+				length = len;
+				goto done;
+			}
+			if (ret != -ENOSPC && ret != -EPROTONOSUPPORT)
+				return ret;
+		}
+
+		/*
+		 * Without hashes to check first, compressed data can be
+		 * decompressed as it is read, without staging it in memory
+		 */
+		if (!IS_ENABLED(CONFIG_SPL_FIT_SIGNATURE) &&
+		    !IS_ENABLED(CONFIG_SPL_FIT_IMAGE_POST_PROCESS) &&
+		    spl_fit_decomp_stream_supported(image_comp)) {
+			ret = spl_load_fit_image_decomp(info, sector, offset,
+							len, image_comp,
+							load_addr, &length);
+			if (!ret)
+				goto done;
+			if (ret != -ENOMEM)
+				return ret;
+		}
+
 		load_ptr = (load_addr + align_len) & ~align_len;
+#ifdef CONFIG_SYS_LOAD_ADDR
+		/* Don't read compressed data where it is decompressed to */
+		if (spl_fit_decomp_supported(image_comp))
+			load_ptr = ALIGN(CONFIG_SYS_LOAD_ADDR, ARCH_DMA_MINALIGN);
+#endif
 		length = len;
 
 		overhead = get_aligned_image_overhead(info, offset);
@@ -251,10 +556,36 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 			return -EIO;
 		}
 		length = size;
+	} else if (IS_ENABLED(CONFIG_SPL_ZSTD) && image_comp == IH_COMP_ZSTD) {
+		size_t unc_len = CONFIG_SYS_BOOTM_LEN;
+
+		if (zstd_decompress(src, length, (void *)load_addr, &unc_len)) {
+			puts("Uncompressing error\n");
+			return -EIO;
+		}
+		length = unc_len;
+	} else if (IS_ENABLED(CONFIG_SPL_LZ4) && image_comp == IH_COMP_LZ4) {
+		size_t unc_len = CONFIG_SYS_BOOTM_LEN;
+
+		if (ulz4fn(src, length, (void *)load_addr, &unc_len)) {
+			puts("Uncompressing error\n");
+			return -EIO;
+		}
+		length = unc_len;
+	} else if (IS_ENABLED(CONFIG_SPL_LZMA) && image_comp == IH_COMP_LZMA) {
+		SizeT unc_len = CONFIG_SYS_BOOTM_LEN;
+
+		if (lzmaBuffToBuffDecompress((void *)load_addr, &unc_len, src,
+					     length)) {
+			puts("Uncompressing error\n");
+			return -EIO;
+		}
+		length = unc_len;
 	} else {
 		memcpy((void *)load_addr, src, length);
 	}
 
+done:
 	if (image_info) {
 		image_info->load_addr = load_addr;
 		image_info->size = length;
@@ -7,6 +7,7 @@
 #include <common.h>
 #include <blk.h>
 #include <dm.h>
+#include <malloc.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <dm/uclass-internal.h>
@@ -424,12 +425,44 @@ int blk_get_device(int if_type, int devnum, struct udevice **devp)
 	return device_probe(*devp);
 }
 
+/*
+ * Read @racnt blocks into a temporary buffer so that the blocks after the
+ * request end up in the block cache. Returns the number of blocks copied to
+ * @buffer, or 0 if the caller should fall back to a plain read.
+ */
+static ulong blk_dread_ahead(struct blk_desc *block_dev, lbaint_t start,
+			     lbaint_t blkcnt, lbaint_t racnt, void *buffer)
+{
+	struct udevice *dev = block_dev->bdev;
+	const struct blk_ops *ops = blk_get_ops(dev);
+	ulong blks_read;
+	void *rabuf;
+
+	rabuf = memalign(ARCH_DMA_MINALIGN, racnt * block_dev->blksz);
+	if (!rabuf)
+		return 0;
+
+	blks_read = ops->read(dev, start, racnt, rabuf);
+	if (blks_read == racnt) {
+		blkcache_fill(block_dev->if_type, block_dev->devnum,
+			      start, racnt, block_dev->blksz, rabuf);
+		memcpy(buffer, rabuf, blkcnt * block_dev->blksz);
+		blks_read = blkcnt;
+	} else {
+		blks_read = 0;
+	}
+	free(rabuf);
+
+	return blks_read;
+}
+
 unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 			lbaint_t blkcnt, void *buffer)
 {
 	struct udevice *dev = block_dev->bdev;
 	const struct blk_ops *ops = blk_get_ops(dev);
 	ulong blks_read;
+	lbaint_t racnt;
 
 	if (!ops->read)
 		return -ENOSYS;
@@ -437,6 +470,13 @@ unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 	if (blkcache_read(block_dev->if_type, block_dev->devnum,
 			  start, blkcnt, block_dev->blksz, buffer))
 		return blkcnt;
+
+	racnt = blkcache_readahead(block_dev->if_type, block_dev->devnum,
+				   start, blkcnt, block_dev->lba);
+	if (racnt > blkcnt &&
+	    blk_dread_ahead(block_dev, start, blkcnt, racnt, buffer) == blkcnt)
+		return blkcnt;
+
 	blks_read = ops->read(dev, start, blkcnt, buffer);
 	if (blks_read == blkcnt)
 		blkcache_fill(block_dev->if_type, block_dev->devnum,
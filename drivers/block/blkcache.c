@@ -11,118 +11,274 @@
 #include <linux/ctype.h>
 #include <linux/list.h>
 
+/*
+ * The cache holds individual blocks. Each block is linked into a hash
+ * chain, keyed on (iftype, devnum, blknr), and into a single LRU list
+ * with the most recently used block at the head.
+ */
 struct block_cache_node {
 	struct list_head lh;
+	struct block_cache_node *next;
 	int iftype;
 	int devnum;
-	lbaint_t start;
-	lbaint_t blkcnt;
+	lbaint_t blknr;
 	unsigned long blksz;
 	char *cache;
 };
 
 static LIST_HEAD(block_cache);
 
+static struct block_cache_node **block_cache_hash;
+static unsigned block_cache_hash_bits;
+
 static struct block_cache_stats _stats = {
-	.max_blocks_per_entry = 2,
-	.max_entries = 32
+	.max_blocks_per_entry = 8,
+	.max_entries = 256,
+	.max_readahead = CONFIG_BLOCK_CACHE_READAHEAD,
+};
+
+/* Tracks the last read so that sequential accesses can be detected */
+static struct {
+	int iftype;
+	int devnum;
+	lbaint_t next;
+	bool sequential;
+} ra_state = {
+	.iftype = -1,
 };
 
+static unsigned cache_hash(int iftype, int devnum, lbaint_t blknr)
+{
+	u32 key;
+
+	key = (u32)blknr ^ (u32)((u64)blknr >> 32);
+	key ^= (iftype << 24) ^ (devnum << 16);
+
+	/* multiplicative hashing, keeping the top bits */
+	return (key * 0x9e3779b1) >> (32 - block_cache_hash_bits);
+}
+
+static int cache_init(void)
+{
+	unsigned bits = 4;
+
+	while (bits < 16 && (1U << bits) < _stats.max_entries)
+		bits++;
+
+	block_cache_hash = calloc(1 << bits, sizeof(*block_cache_hash));
+	if (!block_cache_hash)
+		return -ENOMEM;
+	block_cache_hash_bits = bits;
+
+	return 0;
+}
+
 static struct block_cache_node *cache_find(int iftype, int devnum,
-					   lbaint_t start, lbaint_t blkcnt,
+					   lbaint_t blknr,
 					   unsigned long blksz)
 {
 	struct block_cache_node *node;
 
-	list_for_each_entry(node, &block_cache, lh)
-		if ((node->iftype == iftype) &&
+	node = block_cache_hash[cache_hash(iftype, devnum, blknr)];
+	for (; node; node = node->next)
+		if ((node->blknr == blknr) &&
+		    (node->iftype == iftype) &&
 		    (node->devnum == devnum) &&
-		    (node->blksz == blksz) &&
-		    (node->start <= start) &&
-		    (node->start + node->blkcnt >= start + blkcnt)) {
-			if (block_cache.next != &node->lh) {
-				/* maintain MRU ordering */
-				list_del(&node->lh);
-				list_add(&node->lh, &block_cache);
-			}
+		    (node->blksz == blksz)) {
+			/* maintain MRU ordering */
+			if (block_cache.next != &node->lh)
+				list_move(&node->lh, &block_cache);
 			return node;
 		}
 	return 0;
 }
 
-int blkcache_read(int iftype, int devnum,
-		  lbaint_t start, lbaint_t blkcnt,
-		  unsigned long blksz, void *buffer)
+static void cache_unhash(struct block_cache_node *node)
 {
-	struct block_cache_node *node = cache_find(iftype, devnum, start,
-						   blkcnt, blksz);
-	if (node) {
-		const char *src = node->cache + (start - node->start) * blksz;
-		memcpy(buffer, src, blksz * blkcnt);
-		debug("hit: start " LBAF ", count " LBAFU "\n",
-		      start, blkcnt);
-		++_stats.hits;
-		return 1;
-	}
+	struct block_cache_node **pp;
 
-	debug("miss: start " LBAF ", count " LBAFU "\n",
-	      start, blkcnt);
-	++_stats.misses;
-	return 0;
+	pp = &block_cache_hash[cache_hash(node->iftype, node->devnum,
+					  node->blknr)];
+	for (; *pp; pp = &(*pp)->next)
+		if (*pp == node) {
+			*pp = node->next;
+			break;
+		}
 }
 
-void blkcache_fill(int iftype, int devnum,
-		   lbaint_t start, lbaint_t blkcnt,
-		   unsigned long blksz, void const *buffer)
+static void cache_free_all(void)
 {
-	lbaint_t bytes;
 	struct block_cache_node *node;
 
-	/* don't cache big stuff */
-	if (blkcnt > _stats.max_blocks_per_entry)
-		return;
+	while (!list_empty(&block_cache)) {
+		node = list_first_entry(&block_cache, struct block_cache_node,
+					lh);
+		list_del(&node->lh);
+		free(node->cache);
+		free(node);
+	}
+	_stats.entries = 0;
 
-	if (_stats.max_entries == 0)
-		return;
+	free(block_cache_hash);
+	block_cache_hash = 0;
+}
+
+/* Get a free node for a block of @blksz bytes, evicting the LRU if full */
+static struct block_cache_node *cache_get_node(unsigned long blksz)
+{
+	struct block_cache_node *node;
 
-	bytes = blksz * blkcnt;
 	if (_stats.max_entries <= _stats.entries) {
 		/* pop LRU */
-		node = (struct block_cache_node *)block_cache.prev;
+		node = list_last_entry(&block_cache, struct block_cache_node,
+				       lh);
 		list_del(&node->lh);
+		cache_unhash(node);
 		_stats.entries--;
-		debug("drop: start " LBAF ", count " LBAFU "\n",
-		      node->start, node->blkcnt);
-		if (node->blkcnt * node->blksz < bytes) {
+		debug("drop: blknr " LBAF "\n", node->blknr);
+		if (node->blksz != blksz) {
 			free(node->cache);
 			node->cache = 0;
 		}
 	} else {
 		node = malloc(sizeof(*node));
 		if (!node)
-			return;
+			return 0;
 		node->cache = 0;
 	}
 
 	if (!node->cache) {
-		node->cache = malloc(bytes);
+		node->cache = malloc(blksz);
 		if (!node->cache) {
 			free(node);
-			return;
+			return 0;
 		}
 	}
 
+	return node;
+}
+
+static void ra_track(int iftype, int devnum, lbaint_t start, lbaint_t blkcnt)
+{
+	ra_state.sequential = (ra_state.iftype == iftype) &&
+			      (ra_state.devnum == devnum) &&
+			      (ra_state.next == start);
+	ra_state.iftype = iftype;
+	ra_state.devnum = devnum;
+	ra_state.next = start + blkcnt;
+}
+
+int blkcache_read(int iftype, int devnum,
+		  lbaint_t start, lbaint_t blkcnt,
+		  unsigned long blksz, void *buffer)
+{
+	struct block_cache_node *node;
+	char *dst = buffer;
+	lbaint_t i;
+
+	ra_track(iftype, devnum, start, blkcnt);
+
+	if (!block_cache_hash || blkcnt > _stats.max_blocks_per_entry)
+		goto miss;
+
+	/*
+	 * Copy block by block; on a miss the caller reads the whole range
+	 * from the device into the buffer anyway.
+	 */
+	for (i = 0; i < blkcnt; i++) {
+		node = cache_find(iftype, devnum, start + i, blksz);
+		if (!node)
+			goto miss;
+		memcpy(dst, node->cache, blksz);
+		dst += blksz;
+	}
+
+	debug("hit: start " LBAF ", count " LBAFU "\n",
+	      start, blkcnt);
+	++_stats.hits;
+	return 1;
+
+miss:
+	debug("miss: start " LBAF ", count " LBAFU "\n",
+	      start, blkcnt);
+	++_stats.misses;
+	return 0;
+}
+
+lbaint_t blkcache_readahead(int iftype, int devnum,
+			    lbaint_t start, lbaint_t blkcnt, lbaint_t lba)
+{
+	lbaint_t count;
+
+	if (!_stats.max_readahead || !_stats.max_entries)
+		return blkcnt;
+
+	/* only read ahead for small sequential reads */
+	if (!ra_state.sequential || (ra_state.iftype != iftype) ||
+	    (ra_state.devnum != devnum) ||
+	    (blkcnt > _stats.max_blocks_per_entry) || (start >= lba))
+		return blkcnt;
+
+	count = blkcnt + _stats.max_readahead;
+	if (count > _stats.max_entries)
+		count = _stats.max_entries;
+	if (count > lba - start)
+		count = lba - start;
+	if (count <= blkcnt)
+		return blkcnt;
+
+	debug("readahead: start " LBAF ", count " LBAFU "\n",
+	      start + blkcnt, count - blkcnt);
+	_stats.readahead += count - blkcnt;
+
+	return count;
+}
+
+void blkcache_fill(int iftype, int devnum,
+		   lbaint_t start, lbaint_t blkcnt,
+		   unsigned long blksz, void const *buffer)
+{
+	struct block_cache_node *node;
+	const char *src = buffer;
+	unsigned hash;
+	lbaint_t i;
+
+	/* don't cache big stuff */
+	if (blkcnt > _stats.max_blocks_per_entry + _stats.max_readahead)
+		return;
+
+	if (_stats.max_entries == 0)
+		return;
+
+	if (!block_cache_hash && cache_init())
+		return;
+
 	debug("fill: start " LBAF ", count " LBAFU "\n",
 	      start, blkcnt);
 
-	node->iftype = iftype;
-	node->devnum = devnum;
-	node->start = start;
-	node->blkcnt = blkcnt;
-	node->blksz = blksz;
-	memcpy(node->cache, buffer, bytes);
-	list_add(&node->lh, &block_cache);
-	_stats.entries++;
+	for (i = 0; i < blkcnt; i++, src += blksz) {
+		node = cache_find(iftype, devnum, start + i, blksz);
+		if (node) {
+			memcpy(node->cache, src, blksz);
+			continue;
+		}
+
+		node = cache_get_node(blksz);
+		if (!node)
+			return;
+
+		node->iftype = iftype;
+		node->devnum = devnum;
+		node->blknr = start + i;
+		node->blksz = blksz;
+		memcpy(node->cache, src, blksz);
+
+		hash = cache_hash(iftype, devnum, node->blknr);
+		node->next = block_cache_hash[hash];
+		block_cache_hash[hash] = node;
+		list_add(&node->lh, &block_cache);
+		_stats.entries++;
+	}
 }
 
 void blkcache_invalidate(int iftype, int devnum)
@@ -135,33 +291,34 @@ void blkcache_invalidate(int iftype, int devnum)
 		if ((node->iftype == iftype) &&
 		    (node->devnum == devnum)) {
 			list_del(entry);
+			cache_unhash(node);
 			free(node->cache);
 			free(node);
 			--_stats.entries;
 		}
 	}
+
+	if ((ra_state.iftype == iftype) && (ra_state.devnum == devnum))
+		ra_state.iftype = -1;
 }
 
-void blkcache_configure(unsigned blocks, unsigned entries)
+void blkcache_configure(unsigned blocks, unsigned entries, unsigned readahead)
 {
-	struct block_cache_node *node;
 	if ((blocks != _stats.max_blocks_per_entry) ||
-	    (entries != _stats.max_entries)) {
+	    (entries != _stats.max_entries) ||
+	    (readahead != _stats.max_readahead)) {
 		/* invalidate cache */
-		while (!list_empty(&block_cache)) {
-			node = (struct block_cache_node *)block_cache.next;
-			list_del(&node->lh);
-			free(node->cache);
-			free(node);
-		}
-		_stats.entries = 0;
+		cache_free_all();
+		ra_state.iftype = -1;
 	}
 
 	_stats.max_blocks_per_entry = blocks;
 	_stats.max_entries = entries;
+	_stats.max_readahead = readahead;
 
 	_stats.hits = 0;
 	_stats.misses = 0;
+	_stats.readahead = 0;
 }
 
 void blkcache_stats(struct block_cache_stats *stats)
@@ -169,4 +326,5 @@ void blkcache_stats(struct block_cache_stats *stats)
 	memcpy(stats, &_stats, sizeof(*stats));
 	_stats.hits = 0;
 	_stats.misses = 0;
+	_stats.readahead = 0;
 }
@@ -374,6 +374,7 @@ int device_probe(struct udevice *dev)
 		goto fail;
 	}
 	dev->seq = seq;
+	uclass_index_add(dev, DM_INDEX_SEQ);
 
 	dev->flags |= DM_FLAG_ACTIVATED;
 
@@ -436,6 +437,7 @@ fail_uclass:
 fail:
 	dev->flags &= ~DM_FLAG_ACTIVATED;
 
+	uclass_index_del(dev, DM_INDEX_SEQ);
 	dev->seq = -1;
 	device_free(dev);
 
@@ -642,6 +644,8 @@ static struct udevice *_device_find_global_by_ofnode(struct udevice *parent,
 int device_find_global_by_ofnode(ofnode ofnode, struct udevice **devp)
 {
 	*devp = _device_find_global_by_ofnode(gd->dm_root, ofnode);
+	if (!*devp && !lists_bind_pending_ofnode(ofnode))
+		*devp = _device_find_global_by_ofnode(gd->dm_root, ofnode);
 
 	return *devp ? 0 : -ENOENT;
 }
@@ -651,6 +655,8 @@ int device_get_global_by_ofnode(ofnode ofnode, struct udevice **devp)
 	struct udevice *dev;
 
 	dev = _device_find_global_by_ofnode(gd->dm_root, ofnode);
+	if (!dev && !lists_bind_pending_ofnode(ofnode))
+		dev = _device_find_global_by_ofnode(gd->dm_root, ofnode);
 	return device_get_device_tail(dev, dev ? 0 : -ENOENT, devp);
 }
 
@@ -774,6 +780,13 @@ int device_set_name(struct udevice *dev, const char *name)
 	return 0;
 }
 
+void dev_set_ofnode(struct udevice *dev, ofnode node)
+{
+	uclass_index_del(dev, DM_INDEX_NODE);
+	dev->node = node;
+	uclass_index_add(dev, DM_INDEX_NODE);
+}
+
 bool device_is_compatible(struct udevice *dev, const char *compat)
 {
 	return ofnode_device_is_compatible(dev_ofnode(dev), compat);
@@ -16,6 +16,9 @@
 #include <dm/util.h>
 #include <fdtdec.h>
 #include <linux/compiler.h>
+#include <malloc.h>
+
+DECLARE_GLOBAL_DATA_PTR;
 
 struct driver *lists_driver_lookup_name(const char *name)
 {
@@ -122,10 +125,129 @@ static int driver_check_compatible(const struct udevice_id *of_match,
 	return -ENOENT;
 }
 
-int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp)
+#if CONFIG_IS_ENABLED(DM_COMPAT_HASH)
+struct lists_compat_entry {
+	const struct udevice_id *id;
+	struct driver *drv;
+};
+
+/* Open-addressed hash table of all compatible strings in the driver list */
+struct lists_compat {
+	unsigned int mask;
+	struct lists_compat_entry ent[];
+};
+
+static unsigned int lists_compat_hash(const char *compat)
+{
+	unsigned int hash = 2166136261u;
+
+	while (*compat)
+		hash = (hash ^ (unsigned char)*compat++) * 16777619;
+
+	return hash;
+}
+
+static struct lists_compat *lists_compat_build(void)
 {
 	struct driver *driver = ll_entry_start(struct driver, driver);
 	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *of_match;
+	struct lists_compat_entry *ent;
+	struct lists_compat *tab;
+	struct driver *entry;
+	unsigned int size, i;
+	int count = 0;
+
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (of_match = entry->of_match; of_match && of_match->compatible;
+		     of_match++)
+			count++;
+	}
+	for (size = 16; size < count * 2; size <<= 1)
+		;
+
+	tab = calloc(1, sizeof(*tab) + size * sizeof(tab->ent[0]));
+	if (!tab)
+		return NULL;
+	tab->mask = size - 1;
+
+	/* The first driver in the list wins, as with a linear search */
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (of_match = entry->of_match; of_match && of_match->compatible;
+		     of_match++) {
+			i = lists_compat_hash(of_match->compatible);
+			for (;; i++) {
+				ent = &tab->ent[i & tab->mask];
+				if (!ent->id) {
+					ent->id = of_match;
+					ent->drv = entry;
+					break;
+				}
+				if (!strcmp(ent->id->compatible,
+					    of_match->compatible))
+					break;
+			}
+		}
+	}
+
+	return tab;
+}
+
+static struct driver *lists_compat_find(struct lists_compat *tab,
+					const char *compat,
+					const struct udevice_id **idp)
+{
+	struct lists_compat_entry *ent;
+	unsigned int i;
+
+	for (i = lists_compat_hash(compat);; i++) {
+		ent = &tab->ent[i & tab->mask];
+		if (!ent->id)
+			return NULL;
+		if (!strcmp(ent->id->compatible, compat)) {
+			*idp = ent->id;
+			return ent->drv;
+		}
+	}
+}
+#endif
+
+/**
+ * lists_driver_lookup_compat() - Find the driver for a compatible string
+ *
+ * @compat:	The compatible string to search for
+ * @idp:	Returns the match that was found
+ * @return the first driver in the list which matches, or NULL if none
+ */
+static struct driver *lists_driver_lookup_compat(const char *compat,
+						 const struct udevice_id **idp)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	struct driver *entry;
+
+#if CONFIG_IS_ENABLED(DM_COMPAT_HASH)
+	/*
+	 * Driver pointers are only final after relocation, so build the table
+	 * then
+	 */
+	if (gd->flags & GD_FLG_RELOC) {
+		if (!gd->dm_compat)
+			gd->dm_compat = lists_compat_build();
+		if (gd->dm_compat)
+			return lists_compat_find(gd->dm_compat, compat, idp);
+	}
+#endif
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		if (!driver_check_compatible(entry->of_match, idp, compat))
+			return entry;
+	}
+
+	return NULL;
+}
+
+int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp)
+{
 	const struct udevice_id *id;
 	struct driver *entry;
 	struct udevice *dev;
@@ -162,13 +284,8 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp)
 		pr_debug("   - attempt to match compatible string '%s'\n",
 			 compat);
 
-		for (entry = driver; entry != driver + n_ents; entry++) {
-			ret = driver_check_compatible(entry->of_match, &id,
-						      compat);
-			if (!ret)
-				break;
-		}
-		if (entry == driver + n_ents)
+		entry = lists_driver_lookup_compat(compat, &id);
+		if (!entry)
 			continue;
 
 		pr_debug("   - found match at '%s'\n", entry->name);
@@ -195,4 +312,159 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp)
 
 	return result;
 }
+
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+/* A device tree node which has not been bound yet */
+struct lists_pending_node {
+	struct list_head sibling_node;
+	struct udevice *parent;
+	ofnode node;
+	enum uclass_id id;
+};
+
+struct lists_pending {
+	struct list_head head;
+	unsigned int count[UCLASS_COUNT];
+	bool defer;
+};
+
+void lists_defer_bind(bool defer)
+{
+	struct lists_pending *pend = gd->dm_pending;
+
+	if (!pend && defer) {
+		/* Without memory, nodes are just bound straight away */
+		pend = calloc(1, sizeof(*pend));
+		if (!pend)
+			return;
+		INIT_LIST_HEAD(&pend->head);
+		gd->dm_pending = pend;
+	}
+	if (pend)
+		pend->defer = defer;
+}
+
+int lists_bind_fdt_lazy(struct udevice *parent, ofnode node)
+{
+	struct lists_pending *pend = gd->dm_pending;
+	struct lists_pending_node *pn;
+	const struct udevice_id *id;
+	const char *compat_list, *compat;
+	struct driver *drv = NULL;
+	int compat_length, i;
+
+	/*
+	 * Binding a device calls uclass_get(), which first binds the recorded
+	 * nodes of its uclass. So the devices in a uclass stay in device tree
+	 * order, whichever of them are recorded here.
+	 */
+	if (!pend || !pend->defer || !(gd->flags & GD_FLG_RELOC) ||
+	    ofnode_valid(ofnode_first_subnode(node)))
+		return lists_bind_fdt(parent, node, NULL);
+	if (parent != gd->dm_root &&
+	    device_get_uclass_id(parent) != UCLASS_SIMPLE_BUS)
+		return lists_bind_fdt(parent, node, NULL);
+
+	compat_list = ofnode_get_property(node, "compatible", &compat_length);
+	for (i = 0; compat_list && !drv && i < compat_length;
+	     i += strlen(compat) + 1) {
+		compat = compat_list + i;
+		drv = lists_driver_lookup_compat(compat, &id);
+	}
+	if (!drv)
+		return lists_bind_fdt(parent, node, NULL);
+
+	pn = malloc(sizeof(*pn));
+	if (!pn)
+		return lists_bind_fdt(parent, node, NULL);
+	pn->parent = parent;
+	pn->node = node;
+	pn->id = drv->id;
+	list_add_tail(&pn->sibling_node, &pend->head);
+	pend->count[pn->id]++;
+	pr_debug("defer node %s\n", ofnode_get_name(node));
+
+	return 0;
+}
+
+int lists_bind_pending(enum uclass_id id)
+{
+	struct lists_pending *pend = gd->dm_pending;
+	struct lists_pending_node *pn, *next;
+	LIST_HEAD(todo);
+	int ret = 0, err;
+
+	if (!pend || id < 0 || id >= UCLASS_COUNT || !pend->count[id])
+		return 0;
+
+	/*
+	 * Take the nodes off the list first, since binding them calls
+	 * uclass_get() and so comes back here
+	 */
+	list_for_each_entry_safe(pn, next, &pend->head, sibling_node) {
+		if (pn->id == id)
+			list_move_tail(&pn->sibling_node, &todo);
+	}
+	pend->count[id] = 0;
+
+	list_for_each_entry_safe(pn, next, &todo, sibling_node) {
+		err = lists_bind_fdt(pn->parent, pn->node, NULL);
+		if (err && !ret) {
+			ret = err;
+			dm_warn("Some drivers failed to bind\n");
+		}
+		list_del(&pn->sibling_node);
+		free(pn);
+	}
+
+	return ret;
+}
+
+int lists_bind_pending_ofnode(ofnode node)
+{
+	struct lists_pending *pend = gd->dm_pending;
+	struct lists_pending_node *pn;
+
+	if (!pend)
+		return -ENOENT;
+
+	list_for_each_entry(pn, &pend->head, sibling_node) {
+		if (ofnode_equal(pn->node, node))
+			return lists_bind_pending(pn->id);
+	}
+
+	return -ENOENT;
+}
+
+void lists_drop_pending(struct udevice *parent)
+{
+	struct lists_pending *pend = gd->dm_pending;
+	struct lists_pending_node *pn, *next;
+
+	if (!pend)
+		return;
+
+	list_for_each_entry_safe(pn, next, &pend->head, sibling_node) {
+		if (parent && pn->parent != parent)
+			continue;
+		pend->count[pn->id]--;
+		list_del(&pn->sibling_node);
+		free(pn);
+	}
+
+	if (!parent) {
+		free(pend);
+		gd->dm_pending = NULL;
+	}
+}
+#endif
+#endif
+
+void lists_uninit(void)
+{
+	lists_drop_pending(NULL);
+#if CONFIG_IS_ENABLED(DM_COMPAT_HASH)
+	free(gd->dm_compat);
+	gd->dm_compat = NULL;
 #endif
+}
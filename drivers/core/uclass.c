@@ -130,6 +130,9 @@ int uclass_destroy(struct uclass *uc)
 	list_del(&uc->sibling_node);
 	if (uc_drv->priv_auto_alloc_size)
 		free(uc->priv);
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	free(uc->index);
+#endif
 	free(uc);
 
 	return 0;
@@ -140,6 +143,8 @@ int uclass_get(enum uclass_id id, struct uclass **ucp)
 	struct uclass *uc;
 
 	*ucp = NULL;
+	/* Failures are reported, as when scanning the device tree */
+	lists_bind_pending(id);
 	uc = uclass_find(id);
 	if (!uc)
 		return uclass_add(id, ucp);
@@ -245,6 +250,144 @@ int uclass_find_next_device(struct udevice **devp)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+/* Uclasses with fewer devices than this are searched by walking the list */
+#define UCLASS_INDEX_MIN	8
+
+static uint uclass_index_hash(struct uclass *uc, ulong key)
+{
+	u32 val = (u32)key;
+
+	if (sizeof(key) > sizeof(val))
+		val ^= (u32)((u64)key >> 32);
+
+	/* multiplicative hashing, keeping the top bits */
+	return (val * 0x9e3779b1) >> (32 - uc->index_bits);
+}
+
+/* Get the chain that @dev belongs in, or NULL if it is not indexed by @index */
+static struct udevice **uclass_index_chain(struct udevice *dev, int index)
+{
+	struct uclass *uc = dev->uclass;
+	ulong key;
+
+	if (!uc->index)
+		return NULL;
+
+	switch (index) {
+	case DM_INDEX_SEQ:
+		if (dev->seq == -1)
+			return NULL;
+		key = dev->seq;
+		break;
+	case DM_INDEX_NODE:
+		if (!ofnode_valid(dev->node))
+			return NULL;
+		key = dev->node.of_offset;
+		break;
+	default:
+		return NULL;
+	}
+
+	return &uc->index[(index << uc->index_bits) +
+			  uclass_index_hash(uc, key)];
+}
+
+void uclass_index_add(struct udevice *dev, int index)
+{
+	struct udevice **pp = uclass_index_chain(dev, index);
+
+	if (!pp)
+		return;
+
+	/* Add to the end so that duplicates are found in the list's order */
+	while (*pp)
+		pp = &(*pp)->index_next[index];
+	*pp = dev;
+	dev->index_next[index] = NULL;
+}
+
+void uclass_index_del(struct udevice *dev, int index)
+{
+	struct udevice **pp = uclass_index_chain(dev, index);
+
+	if (!pp)
+		return;
+
+	for (; *pp; pp = &(*pp)->index_next[index]) {
+		if (*pp == dev) {
+			*pp = dev->index_next[index];
+			break;
+		}
+	}
+}
+
+/* Size the index for the uclass's current number of devices and fill it */
+static int uclass_index_build(struct uclass *uc)
+{
+	struct udevice **index;
+	struct udevice *dev;
+	uint bits = 1;
+	int i;
+
+	while ((1U << bits) < uc->dev_count)
+		bits++;
+
+	index = calloc(DM_INDEX_COUNT << bits, sizeof(*index));
+	if (!index)
+		return -ENOMEM;
+
+	free(uc->index);
+	uc->index = index;
+	uc->index_bits = bits;
+	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
+		for (i = 0; i < DM_INDEX_COUNT; i++)
+			uclass_index_add(dev, i);
+	}
+
+	return 0;
+}
+
+static void uclass_index_bind(struct udevice *dev)
+{
+	struct uclass *uc = dev->uclass;
+	int i;
+
+	/*
+	 * Grow the index so that chains hold two devices on average. If there
+	 * is no memory, keep using the old index (or the list).
+	 */
+	uc->dev_count++;
+	if (uc->dev_count >= UCLASS_INDEX_MIN &&
+	    (!uc->index || uc->dev_count > (2U << uc->index_bits)) &&
+	    !uclass_index_build(uc))
+		return;
+
+	for (i = 0; i < DM_INDEX_COUNT; i++)
+		uclass_index_add(dev, i);
+}
+
+static void uclass_index_unbind(struct udevice *dev)
+{
+	int i;
+
+	for (i = 0; i < DM_INDEX_COUNT; i++)
+		uclass_index_del(dev, i);
+	dev->uclass->dev_count--;
+}
+
+/* Find the first device in the chain for @key of @index, if indexed */
+static struct udevice *uclass_index_first(struct uclass *uc, int index,
+					  ulong key)
+{
+	return uc->index[(index << uc->index_bits) +
+			 uclass_index_hash(uc, key)];
+}
+#else
+static inline void uclass_index_bind(struct udevice *dev) {}
+static inline void uclass_index_unbind(struct udevice *dev) {}
+#endif
+
 int uclass_find_device_by_name(enum uclass_id id, const char *name,
 			       struct udevice **devp)
 {
@@ -284,6 +427,23 @@ int uclass_find_device_by_seq(enum uclass_id id, int seq_or_req_seq,
 	if (ret)
 		return ret;
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	/* Requested sequence numbers can change at any time, so are not indexed */
+	if (uc->index && !find_req_seq) {
+		dev = uclass_index_first(uc, DM_INDEX_SEQ, seq_or_req_seq);
+		for (; dev; dev = dev->index_next[DM_INDEX_SEQ]) {
+			if (dev->seq == seq_or_req_seq) {
+				*devp = dev;
+				debug("   - found '%s'\n", dev->name);
+				return 0;
+			}
+		}
+		debug("   - not found\n");
+
+		return -ENODEV;
+	}
+#endif
+
 	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
 		debug("   - %d %d '%s'\n", dev->req_seq, dev->seq, dev->name);
 		if ((find_req_seq ? dev->req_seq : dev->seq) ==
@@ -337,6 +497,20 @@ int uclass_find_device_by_ofnode(enum uclass_id id, ofnode node,
 	if (ret)
 		return ret;
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	if (uc->index) {
+		dev = uclass_index_first(uc, DM_INDEX_NODE, node.of_offset);
+		for (; dev; dev = dev->index_next[DM_INDEX_NODE]) {
+			if (ofnode_equal(dev_ofnode(dev), node)) {
+				*devp = dev;
+				goto done;
+			}
+		}
+		ret = -ENODEV;
+		goto done;
+	}
+#endif
+
 	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
 		log(LOGC_DM, LOGL_DEBUG_CONTENT, "      - checking %s\n",
 		    dev->name);
@@ -609,6 +783,7 @@ int uclass_bind_device(struct udevice *dev)
 
 	uc = dev->uclass;
 	list_add_tail(&dev->uclass_node, &uc->dev_head);
+	uclass_index_bind(dev);
 
 	if (dev->parent) {
 		struct uclass_driver *uc_drv = dev->parent->uclass->uc_drv;
@@ -623,6 +798,7 @@ int uclass_bind_device(struct udevice *dev)
 	return 0;
 err:
 	/* There is no need to undo the parent's post_bind call */
+	uclass_index_unbind(dev);
 	list_del(&dev->uclass_node);
 
 	return ret;
@@ -641,6 +817,7 @@ int uclass_unbind_device(struct udevice *dev)
 			return ret;
 	}
 
+	uclass_index_unbind(dev);
 	list_del(&dev->uclass_node);
 	return 0;
 }
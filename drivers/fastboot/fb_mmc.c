@@ -13,6 +13,7 @@
 #include <part.h>
 #include <mmc.h>
 #include <div64.h>
+#include <linux/math64.h>
 #include <linux/compat.h>
 #include <android_image.h>
 
@@ -96,6 +97,45 @@ static lbaint_t fb_mmc_sparse_reserve(struct sparse_storage *info,
 	return blkcnt;
 }
 
+#ifdef CONFIG_IMAGE_SPARSE_ERASE
+/*
+ * Erase whole erase groups. The MMC erases every group that a range touches,
+ * so the chunks must stay aligned to the group size or the blocks around
+ * them would be lost.
+ */
+static lbaint_t fb_mmc_sparse_erase(struct sparse_storage *info,
+		lbaint_t blk, lbaint_t blkcnt)
+{
+	struct fb_mmc_sparse *sparse = info->priv;
+	struct blk_desc *dev_desc = sparse->dev_desc;
+	lbaint_t grp_size = info->erase_blks;
+	lbaint_t chunk, cur_blkcnt;
+	lbaint_t blks = 0;
+	u32 rem_start, rem_cnt;
+
+	div_u64_rem(blk, grp_size, &rem_start);
+	div_u64_rem(blkcnt, grp_size, &rem_cnt);
+	if (rem_start || rem_cnt) {
+		pr_err("erase of " LBAFU " blocks at " LBAFU
+		       " is not aligned to the erase group\n", blkcnt, blk);
+		return 0;
+	}
+
+	chunk = max_t(lbaint_t, grp_size,
+		      FASTBOOT_MAX_BLK_WRITE / grp_size * grp_size);
+	while (blks < blkcnt) {
+		cur_blkcnt = min(blkcnt - blks, chunk);
+		if (fastboot_progress_callback)
+			fastboot_progress_callback("erasing");
+		if (blk_derase(dev_desc, blk + blks, cur_blkcnt) != cur_blkcnt)
+			break;
+		blks += cur_blkcnt;
+	}
+
+	return blks;
+}
+#endif
+
 static void write_raw_image(struct blk_desc *dev_desc, disk_partition_t *info,
 		const char *part_name, void *buffer,
 		u32 download_bytes, char *response)
@@ -403,6 +443,9 @@ void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 	if (is_sparse_image(download_buffer)) {
 		struct fb_mmc_sparse sparse_priv;
 		struct sparse_storage sparse;
+#ifdef CONFIG_IMAGE_SPARSE_ERASE
+		struct mmc *mmc;
+#endif
 		int err;
 
 		sparse_priv.dev_desc = dev_desc;
@@ -412,8 +455,17 @@ void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 		sparse.size = info.size;
 		sparse.write = fb_mmc_sparse_write;
 		sparse.reserve = fb_mmc_sparse_reserve;
+		sparse.erase = NULL;
 		sparse.mssg = fastboot_fail;
 
+#ifdef CONFIG_IMAGE_SPARSE_ERASE
+		mmc = find_mmc_device(dev_desc->devnum);
+		if (mmc && mmc_erase_is_zero(mmc)) {
+			sparse.erase = fb_mmc_sparse_erase;
+			sparse.erase_blks = mmc->erase_grp_size;
+		}
+#endif
+
 		printf("Flashing sparse image at offset " LBAFU "\n",
 		       sparse.start);
 
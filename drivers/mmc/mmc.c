@@ -2758,6 +2758,14 @@ int mmc_set_dsr(struct mmc *mmc, u16 val)
 	return 0;
 }
 
+bool mmc_erase_is_zero(struct mmc *mmc)
+{
+	if (IS_SD(mmc))
+		return !(mmc->scr[0] & SD_DATA_STAT_AFTER_ERASE);
+
+	return mmc->ext_csd && !mmc->ext_csd[EXT_CSD_ERASED_MEM_CONT];
+}
+
 /* CPU-specific MMC initializations */
 __weak int cpu_mmc_init(bd_t *bis)
 {
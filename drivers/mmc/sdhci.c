@@ -72,12 +72,6 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 {
 	unsigned int stat, rdy, mask, timeout, block = 0;
 	bool transfer_done = false;
-#ifdef CONFIG_MMC_SDHCI_SDMA
-	unsigned char ctrl;
-	ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
-	ctrl &= ~SDHCI_CTRL_DMA_MASK;
-	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
-#endif
 
 	timeout = 1000000;
 	rdy = SDHCI_INT_SPACE_AVAIL | SDHCI_INT_DATA_AVAIL;
@@ -105,7 +99,8 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 			}
 		}
 #ifdef CONFIG_MMC_SDHCI_SDMA
-		if (!transfer_done && (stat & SDHCI_INT_DMA_END)) {
+		if (!transfer_done && (host->flags & USE_SDMA) &&
+		    (stat & SDHCI_INT_DMA_END)) {
 			sdhci_writel(host, SDHCI_INT_DMA_END, SDHCI_INT_STATUS);
 			start_addr &= ~(SDHCI_DEFAULT_BOUNDARY_SIZE - 1);
 			start_addr += SDHCI_DEFAULT_BOUNDARY_SIZE;
@@ -122,6 +117,137 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 	return 0;
 }
 
+#ifdef CONFIG_MMC_SDHCI_ADMA
+static void sdhci_adma_desc(struct sdhci_host *host, int slot,
+			    dma_addr_t addr, uint len, bool end)
+{
+	struct sdhci_adma_desc *desc;
+
+	if (host->flags & USE_ADMA64)
+		desc = host->adma_desc_table + slot * ADMA64_DESC_LEN;
+	else
+		desc = host->adma_desc_table + slot * ADMA32_DESC_LEN;
+
+	desc->attr = ADMA_DESC_ATTR_VALID | ADMA_DESC_TRANSFER_DATA;
+	if (end)
+		desc->attr |= ADMA_DESC_ATTR_END;
+	desc->reserved = 0;
+	desc->len = cpu_to_le16(len);
+	desc->addr_lo = cpu_to_le32(lower_32_bits(addr));
+	if (host->flags & USE_ADMA64)
+		desc->addr_hi = cpu_to_le32(upper_32_bits(addr));
+}
+
+/*
+ * Describe the whole transfer in the descriptor table, so that the
+ * controller moves all of it without any help from the CPU.
+ */
+static void sdhci_prepare_adma_table(struct sdhci_host *host,
+				     struct mmc_data *data, dma_addr_t addr)
+{
+	uint trans_bytes = data->blocks * data->blocksize;
+	ulong table = (ulong)host->adma_desc_table;
+	uint len;
+	int slot = 0;
+
+	while (trans_bytes) {
+		len = min_t(uint, trans_bytes, ADMA_MAX_LEN);
+		trans_bytes -= len;
+		sdhci_adma_desc(host, slot++, addr, len, !trans_bytes);
+		addr += len;
+	}
+
+	if (host->flags & USE_ADMA64)
+		len = slot * ADMA64_DESC_LEN;
+	else
+		len = slot * ADMA32_DESC_LEN;
+	flush_cache(table, ALIGN(len, ARCH_DMA_MINALIGN));
+
+	sdhci_writel(host, lower_32_bits(table), SDHCI_ADMA_ADDRESS);
+	if (host->flags & USE_ADMA64)
+		sdhci_writel(host, upper_32_bits(table), SDHCI_ADMA_ADDRESS_HI);
+}
+#endif
+
+#if defined(CONFIG_MMC_SDHCI_SDMA) || defined(CONFIG_MMC_SDHCI_ADMA)
+/*
+ * Select the DMA mode and point the controller at the data. Returns false
+ * if this transfer has to be done by PIO instead.
+ */
+static bool sdhci_prepare_dma(struct sdhci_host *host, struct mmc_data *data,
+			      unsigned int *start_addr, int *is_aligned,
+			      int trans_bytes)
+{
+	unsigned char ctrl;
+	ulong addr;
+
+	if (data->flags == MMC_DATA_READ)
+		addr = (ulong)data->dest;
+	else
+		addr = (ulong)data->src;
+
+	ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
+	ctrl &= ~SDHCI_CTRL_DMA_MASK;
+
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	if (host->flags & USE_ADMA) {
+		/* ADMA2 needs 32-bit (64-bit) aligned data */
+		if (addr & ((host->flags & USE_ADMA64) ? 0x7 : 0x3)) {
+			debug("%s: unaligned buffer %lx, using PIO\n",
+			      __func__, addr);
+			sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
+			return false;
+		}
+
+		/* 32-bit ADMA descriptors cannot hold an address above 4GiB */
+		if (!(host->flags & USE_ADMA64) &&
+		    upper_32_bits((u64)addr + trans_bytes - 1)) {
+			debug("%s: buffer %lx above 4GiB, using PIO\n",
+			      __func__, addr);
+			sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
+			return false;
+		}
+
+		if (host->flags & USE_ADMA64)
+			ctrl |= SDHCI_CTRL_ADMA64;
+		else
+			ctrl |= SDHCI_CTRL_ADMA32;
+		sdhci_prepare_adma_table(host, data, addr);
+	}
+#endif
+#ifdef CONFIG_MMC_SDHCI_SDMA
+	if (host->flags & USE_SDMA) {
+		if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
+				(addr & 0x7) != 0x0) {
+			*is_aligned = 0;
+			addr = (unsigned long)aligned_buffer;
+			if (data->flags != MMC_DATA_READ)
+				memcpy(aligned_buffer, data->src, trans_bytes);
+		}
+
+#if defined(CONFIG_FIXED_SDHCI_ALIGNED_BUFFER)
+		/*
+		 * Always use this bounce-buffer when
+		 * CONFIG_FIXED_SDHCI_ALIGNED_BUFFER is defined
+		 */
+		*is_aligned = 0;
+		addr = (unsigned long)aligned_buffer;
+		if (data->flags != MMC_DATA_READ)
+			memcpy(aligned_buffer, data->src, trans_bytes);
+#endif
+
+		sdhci_writel(host, addr, SDHCI_DMA_ADDRESS);
+	}
+#endif
+	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
+
+	flush_cache(addr, ALIGN(trans_bytes, CONFIG_SYS_CACHELINE_SIZE));
+	*start_addr = addr;
+
+	return true;
+}
+#endif
+
 /*
  * No command will be sent by driver if card is busy, so driver must wait
  * for card ready state.
@@ -218,32 +344,10 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 		if (data->flags == MMC_DATA_READ)
 			mode |= SDHCI_TRNS_READ;
 
-#ifdef CONFIG_MMC_SDHCI_SDMA
-		if (data->flags == MMC_DATA_READ)
-			start_addr = (unsigned long)data->dest;
-		else
-			start_addr = (unsigned long)data->src;
-		if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
-				(start_addr & 0x7) != 0x0) {
-			is_aligned = 0;
-			start_addr = (unsigned long)aligned_buffer;
-			if (data->flags != MMC_DATA_READ)
-				memcpy(aligned_buffer, data->src, trans_bytes);
-		}
-
-#if defined(CONFIG_FIXED_SDHCI_ALIGNED_BUFFER)
-		/*
-		 * Always use this bounce-buffer when
-		 * CONFIG_FIXED_SDHCI_ALIGNED_BUFFER is defined
-		 */
-		is_aligned = 0;
-		start_addr = (unsigned long)aligned_buffer;
-		if (data->flags != MMC_DATA_READ)
-			memcpy(aligned_buffer, data->src, trans_bytes);
-#endif
-
-		sdhci_writel(host, start_addr, SDHCI_DMA_ADDRESS);
-		mode |= SDHCI_TRNS_DMA;
+#if defined(CONFIG_MMC_SDHCI_SDMA) || defined(CONFIG_MMC_SDHCI_ADMA)
+		if (sdhci_prepare_dma(host, data, &start_addr, &is_aligned,
+				      trans_bytes))
+			mode |= SDHCI_TRNS_DMA;
 #endif
 		sdhci_writew(host, SDHCI_MAKE_BLKSZ(SDHCI_DEFAULT_BOUNDARY_ARG,
 				data->blocksize),
@@ -255,12 +359,6 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	}
 
 	sdhci_writel(host, cmd->cmdarg, SDHCI_ARGUMENT);
-#ifdef CONFIG_MMC_SDHCI_SDMA
-	if (data) {
-		trans_bytes = ALIGN(trans_bytes, CONFIG_SYS_CACHELINE_SIZE);
-		flush_cache(start_addr, trans_bytes);
-	}
-#endif
 	sdhci_writew(host, SDHCI_MAKE_CMD(cmd->cmdidx, flags), SDHCI_COMMAND);
 	start = get_timer(0);
 	do {
@@ -564,12 +662,39 @@ int sdhci_setup_cfg(struct mmc_config *cfg, struct sdhci_host *host,
 
 	caps = sdhci_readl(host, SDHCI_CAPABILITIES);
 
-#ifdef CONFIG_MMC_SDHCI_SDMA
-	if (!(caps & SDHCI_CAN_DO_SDMA)) {
-		printf("%s: Your controller doesn't support SDMA!!\n",
+	host->flags &= ~(USE_SDMA | USE_ADMA | USE_ADMA64);
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	if (caps & SDHCI_CAN_DO_ADMA2) {
+		if (!host->adma_desc_table) {
+			host->adma_desc_table = memalign(ARCH_DMA_MINALIGN,
+							 ADMA_TABLE_SZ);
+			if (!host->adma_desc_table)
+				return -ENOMEM;
+		}
+		host->flags |= USE_ADMA;
+		if (IS_ENABLED(CONFIG_DMA_ADDR_T_64BIT) &&
+		    (caps & SDHCI_CAN_64BIT))
+			host->flags |= USE_ADMA64;
+		/* 32-bit ADMA cannot use a descriptor table above 4GiB */
+		if (!(host->flags & USE_ADMA64) &&
+		    upper_32_bits((u64)(ulong)host->adma_desc_table))
+			host->flags &= ~USE_ADMA;
+	}
+	if (!(host->flags & USE_ADMA) && !IS_ENABLED(CONFIG_MMC_SDHCI_SDMA)) {
+		printf("%s: Your controller doesn't support ADMA!!\n",
 		       __func__);
 		return -EINVAL;
 	}
+#endif
+#ifdef CONFIG_MMC_SDHCI_SDMA
+	if (!(host->flags & USE_ADMA)) {
+		if (!(caps & SDHCI_CAN_DO_SDMA)) {
+			printf("%s: Your controller doesn't support SDMA!!\n",
+			       __func__);
+			return -EINVAL;
+		}
+		host->flags |= USE_SDMA;
+	}
 #endif
 	if (host->quirks & SDHCI_QUIRK_REG32_RW)
 		host->version =
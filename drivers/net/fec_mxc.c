@@ -72,6 +72,11 @@ DECLARE_GLOBAL_DATA_PTR;
 #error "PKTALIGN must be multiple of ARCH_DMA_MINALIGN!"
 #endif
 
+/* RX descriptors are handed back to the FEC a cache line at a time */
+#if ((FEC_RBD_NUM * 8) % ARCH_DMA_MINALIGN != 0)
+#error "FEC_RBD_NUM must fill a whole number of cache lines!"
+#endif
+
 #undef DEBUG
 
 #ifdef CONFIG_FEC_MXC_SWAP_PACKET
@@ -388,6 +393,34 @@ static void fec_rbd_clean(int last, struct fec_bd *prbd)
 	writew(0, &prbd->data_length);
 }
 
+/**
+ * Hand the current receive buffer descriptor back to the FEC
+ * @param[in] fec all we know about the device yet
+ *
+ * Descriptors share cache lines, so they are only marked free once the
+ * whole cache line of descriptors was processed. This also batches the cache
+ * flush and the restart of the receive engine.
+ */
+static void fec_rbd_recycle(struct fec_priv *fec)
+{
+	int size = RXDESC_PER_CACHELINE - 1;
+	ulong addr;
+	int i;
+
+	if ((fec->rbd_index & size) == size) {
+		i = fec->rbd_index - size;
+		addr = (ulong)&fec->rbd_base[i];
+		for (; i <= fec->rbd_index ; i++) {
+			fec_rbd_clean(i == (FEC_RBD_NUM - 1),
+				      &fec->rbd_base[i]);
+		}
+		flush_dcache_range(addr, addr + ARCH_DMA_MINALIGN);
+		fec_rx_task_enable(fec);
+	}
+
+	fec->rbd_index = (fec->rbd_index + 1) % FEC_RBD_NUM;
+}
+
 static int fec_get_hwaddr(int dev_id, unsigned char *mac)
 {
 	imx_get_mac_from_fuse(dev_id, mac);
@@ -828,6 +861,10 @@ out:
  * Pull one frame from the card
  * @param[in] dev Our ethernet device to handle
  * @return Length of packet read
+ *
+ * The frame is passed up in its DMA buffer. With driver model the descriptor
+ * is handed back to the FEC by fecmxc_free_pkt() once the network stack is
+ * done with it.
  */
 #ifdef CONFIG_DM_ETH
 static int fecmxc_recv(struct udevice *dev, int flags, uchar **packetp)
@@ -845,17 +882,7 @@ static int fec_recv(struct eth_device *dev)
 	int frame_length, len = 0;
 	uint16_t bd_status;
 	ulong addr, size, end;
-	int i;
-
-#ifdef CONFIG_DM_ETH
-	*packetp = memalign(ARCH_DMA_MINALIGN, FEC_MAX_PKT_SIZE);
-	if (*packetp == 0) {
-		printf("%s: error allocating packetp\n", __func__);
-		return -ENOMEM;
-	}
-#else
-	ALLOC_CACHE_ALIGN_BUFFER(uchar, buff, FEC_MAX_PKT_SIZE);
-#endif
+	uchar *packet;
 
 	/* Check if any critical events have happened */
 	ievent = readl(&fec->eth->ievent);
@@ -907,13 +934,21 @@ static int fec_recv(struct eth_device *dev)
 	 * that in order to mark the descriptor as processed, we need to change
 	 * the descriptor. The solution is to mark the whole cache line when all
 	 * descriptors in the cache line are processed.
+	 *
+	 * The FEC only ever clears the EMPTY bit, so a descriptor which the
+	 * cache already shows as filled is up to date. Only invalidate while
+	 * it still looks empty, which saves one invalidate per frame when
+	 * frames arrive in bursts.
 	 */
-	addr = (ulong)rbd;
-	addr &= ~(ARCH_DMA_MINALIGN - 1);
-	size = roundup(sizeof(struct fec_bd), ARCH_DMA_MINALIGN);
-	invalidate_dcache_range(addr, addr + size);
-
 	bd_status = readw(&rbd->status);
+	if (bd_status & FEC_RBD_EMPTY) {
+		addr = (ulong)rbd;
+		addr &= ~(ARCH_DMA_MINALIGN - 1);
+		size = roundup(sizeof(struct fec_bd), ARCH_DMA_MINALIGN);
+		invalidate_dcache_range(addr, addr + size);
+
+		bd_status = readw(&rbd->status);
+	}
 	debug("fec_recv: status 0x%x\n", bd_status);
 
 	if (!(bd_status & FEC_RBD_EMPTY)) {
@@ -921,22 +956,24 @@ static int fec_recv(struct eth_device *dev)
 		    ((readw(&rbd->data_length) - 4) > 14)) {
 			/* Get buffer address and size */
 			addr = readl(&rbd->data_pointer);
+			packet = (uchar *)addr;
 			frame_length = readw(&rbd->data_length) - 4;
 			/* Invalidate data cache over the buffer */
 			end = roundup(addr + frame_length, ARCH_DMA_MINALIGN);
 			addr &= ~(ARCH_DMA_MINALIGN - 1);
 			invalidate_dcache_range(addr, end);
 
-			/* Fill the buffer and pass it to upper layers */
+			/* Pass the buffer to upper layers */
 #ifdef CONFIG_FEC_MXC_SWAP_PACKET
-			swap_packet((uint32_t *)addr, frame_length);
+			swap_packet((uint32_t *)packet, frame_length);
 #endif
 
 #ifdef CONFIG_DM_ETH
-			memcpy(*packetp, (char *)addr, frame_length);
+			*packetp = packet;
+			/* fecmxc_free_pkt() recycles the descriptor */
+			return frame_length;
 #else
-			memcpy(buff, (char *)addr, frame_length);
-			net_process_received_packet(buff, frame_length);
+			net_process_received_packet(packet, frame_length);
 #endif
 			len = frame_length;
 		} else {
@@ -945,26 +982,8 @@ static int fec_recv(struct eth_device *dev)
 				      addr, bd_status);
 		}
 
-		/*
-		 * Free the current buffer, restart the engine and move forward
-		 * to the next buffer. Here we check if the whole cacheline of
-		 * descriptors was already processed and if so, we mark it free
-		 * as whole.
-		 */
-		size = RXDESC_PER_CACHELINE - 1;
-		if ((fec->rbd_index & size) == size) {
-			i = fec->rbd_index - size;
-			addr = (ulong)&fec->rbd_base[i];
-			for (; i <= fec->rbd_index ; i++) {
-				fec_rbd_clean(i == (FEC_RBD_NUM - 1),
-					      &fec->rbd_base[i]);
-			}
-			flush_dcache_range(addr,
-					   addr + ARCH_DMA_MINALIGN);
-		}
-
-		fec_rx_task_enable(fec);
-		fec->rbd_index = (fec->rbd_index + 1) % FEC_RBD_NUM;
+		/* Free the current buffer and move forward to the next one */
+		fec_rbd_recycle(fec);
 	}
 	debug("fec_recv: stop\n");
 
@@ -1248,8 +1267,11 @@ static int fecmxc_read_rom_hwaddr(struct udevice *dev)
 
 static int fecmxc_free_pkt(struct udevice *dev, uchar *packet, int length)
 {
-	if (packet)
-		free(packet);
+	struct fec_priv *fec = dev_get_priv(dev);
+
+	/* A frame was passed up from its descriptor, give that back */
+	if (length > 0)
+		fec_rbd_recycle(fec);
 
 	return 0;
 }
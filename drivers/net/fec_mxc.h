@@ -272,9 +272,14 @@ void imx_get_mac_from_fuse(int dev_id, unsigned char *mac);
  * @brief Numbers of buffer descriptors for receiving
  *
  * The number defines the stocked memory buffers for the receiving task.
- * Larger values makes no sense in this limited environment.
+ * A deeper ring avoids dropping frames when the server sends bursts, e.g.
+ * TFTP with a window size larger than one.
  */
+#ifdef CONFIG_FEC_MXC_RX_RING_SIZE
+#define FEC_RBD_NUM		CONFIG_FEC_MXC_RX_RING_SIZE
+#else
 #define FEC_RBD_NUM		64
+#endif
 
 /**
  * @brief Define the ethernet packet size limit in memory
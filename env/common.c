@@ -14,6 +14,7 @@
 #include <search.h>
 #include <errno.h>
 #include <malloc.h>
+#include <memalign.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -26,6 +27,66 @@ struct hsearch_data env_htab = {
 	.change_ok = env_flags_validate,
 };
 
+/* Value of env_htab.changes when the environment last matched storage */
+static unsigned int env_stored_changes;
+static bool env_stored;
+
+void env_set_stored(bool stored)
+{
+	env_stored = stored;
+	env_stored_changes = env_htab.changes;
+}
+
+bool env_changed(void)
+{
+	return !env_stored || env_htab.changes != env_stored_changes;
+}
+
+int env_write_changed(const struct env_write_ops *ops, void *priv,
+		      const void *buf, uint size, uint unit_size)
+{
+	uint units = DIV_ROUND_UP(size, unit_size);
+	uint i, start, n, pos;
+	int ret, written = 0;
+	bool all;
+	char *old;
+
+	old = malloc_cache_aligned(units * unit_size);
+	if (!old)
+		return -ENOMEM;
+
+	all = ops->read(priv, 0, units, size, old) != 0;
+	for (i = 0; i < units; i = start + n) {
+		for (start = i; start < units && !all; start++) {
+			pos = start * unit_size;
+			if (memcmp(old + pos, buf + pos,
+				   min(unit_size, size - pos)))
+				break;
+		}
+		for (n = 0; start + n < units; n++) {
+			pos = (start + n) * unit_size;
+			if (!all && !memcmp(old + pos, buf + pos,
+					    min(unit_size, size - pos)))
+				break;
+		}
+		if (!n)
+			break;
+
+		pos = start * unit_size;
+		ret = ops->write(priv, start, n, min(n * unit_size, size - pos),
+				 buf + pos);
+		if (ret)
+			goto done;
+		written += n;
+	}
+	ret = written;
+
+done:
+	free(old);
+
+	return ret;
+}
+
 /*
  * Read an environment variable as a boolean
  * Return -1 if variable does not exist (default to true)
@@ -81,6 +142,7 @@ void set_default_env(const char *s, int flags)
 			0, NULL) == 0)
 		pr_err("## Error: Environment import failed: errno = %d\n",
 		       errno);
+	env_set_stored(false);
 
 	gd->flags |= GD_FLG_ENV_READY;
 	gd->flags |= GD_FLG_ENV_DEFAULT;
@@ -122,6 +184,7 @@ int env_import(const char *buf, int check)
 	if (himport_r(&env_htab, (char *)ep->data, ENV_SIZE, '\0', 0, 0,
 			0, NULL)) {
 		gd->flags |= GD_FLG_ENV_READY;
+		env_set_stored(true);
 		return 0;
 	}
 
@@ -140,6 +203,7 @@ int env_import_redund(const char *buf1, int buf1_read_fail,
 {
 	int crc1_ok, crc2_ok;
 	env_t *ep, *tmp_env1, *tmp_env2;
+	int ret;
 
 	tmp_env1 = (env_t *)buf1;
 	tmp_env2 = (env_t *)buf2;
@@ -156,10 +220,15 @@ int env_import_redund(const char *buf1, int buf1_read_fail,
 		return -EIO;
 	} else if (!buf1_read_fail && buf2_read_fail) {
 		gd->env_valid = ENV_VALID;
-		return env_import((char *)tmp_env1, 1);
+		ret = env_import((char *)tmp_env1, 1);
+		/* The next save must rewrite the other copy */
+		env_set_stored(false);
+		return ret;
 	} else if (buf1_read_fail && !buf2_read_fail) {
 		gd->env_valid = ENV_REDUND;
-		return env_import((char *)tmp_env2, 1);
+		ret = env_import((char *)tmp_env2, 1);
+		env_set_stored(false);
+		return ret;
 	}
 
 	crc1_ok = crc32(0, tmp_env1->data, ENV_SIZE) ==
@@ -194,7 +263,11 @@ int env_import_redund(const char *buf1, int buf1_read_fail,
 		ep = tmp_env2;
 
 	env_flags = ep->flags;
-	return env_import((char *)ep, 0);
+	ret = env_import((char *)ep, 0);
+	if (!crc1_ok || !crc2_ok)
+		env_set_stored(false);
+
+	return ret;
 }
 #endif /* CONFIG_SYS_REDUNDAND_ENVIRONMENT */
 
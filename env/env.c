@@ -9,6 +9,9 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Location the environment was last loaded from or saved to */
+static enum env_location env_stored_location = ENVL_UNKNOWN;
+
 #if defined(CONFIG_NEEDS_MANUAL_RELOC)
 void env_fix_drivers(void)
 {
@@ -196,6 +199,7 @@ int env_load(void)
 			debug("Failed (%d)\n", ret);
 		} else {
 			printf("OK\n");
+			env_stored_location = drv->location;
 			return 0;
 		}
 	}
@@ -225,14 +229,23 @@ int env_save(void)
 			return -ENODEV;
 
 		printf("Saving Environment to %s... ", drv->name);
+		if (IS_ENABLED(CONFIG_ENV_INCREMENTAL_SAVE) &&
+		    drv->location == env_stored_location && !env_changed()) {
+			printf("unchanged\n");
+			return 0;
+		}
+
 		ret = drv->save();
 		if (ret)
 			printf("Failed (%d)\n", ret);
 		else
 			printf("OK\n");
 
-		if (!ret)
+		if (!ret) {
+			env_set_stored(true);
+			env_stored_location = drv->location;
 			return 0;
+		}
 	}
 
 	return -ENODEV;
@@ -182,6 +182,34 @@ static void fini_mmc_for_env(struct mmc *mmc)
 }
 
 #if defined(CONFIG_CMD_SAVEENV) && !defined(CONFIG_SPL_BUILD)
+struct env_mmc_priv {
+	struct blk_desc *desc;
+	uint blk_start;
+};
+
+static int env_mmc_read_blocks(void *priv, uint unit, uint count, uint len,
+			       void *buf)
+{
+	struct env_mmc_priv *p = priv;
+
+	return blk_dread(p->desc, p->blk_start + unit, count, buf) == count ?
+		0 : -EIO;
+}
+
+static int env_mmc_write_blocks(void *priv, uint unit, uint count, uint len,
+				const void *buf)
+{
+	struct env_mmc_priv *p = priv;
+
+	return blk_dwrite(p->desc, p->blk_start + unit, count, buf) == count ?
+		0 : -EIO;
+}
+
+static const struct env_write_ops env_mmc_ops = {
+	.read	= env_mmc_read_blocks,
+	.write	= env_mmc_write_blocks,
+};
+
 static inline int write_env(struct mmc *mmc, unsigned long size,
 			    unsigned long offset, const void *buffer)
 {
@@ -191,6 +219,20 @@ static inline int write_env(struct mmc *mmc, unsigned long size,
 	blk_start	= ALIGN(offset, mmc->write_bl_len) / mmc->write_bl_len;
 	blk_cnt		= ALIGN(size, mmc->write_bl_len) / mmc->write_bl_len;
 
+	if (IS_ENABLED(CONFIG_ENV_INCREMENTAL_SAVE)) {
+		struct env_mmc_priv priv = { desc, blk_start };
+		int ret;
+
+		/* Only the blocks which differ are written */
+		ret = env_write_changed(&env_mmc_ops, &priv, buffer, size,
+					mmc->write_bl_len);
+		if (ret < 0)
+			return -1;
+		printf("%d of %u blocks written... ", ret, blk_cnt);
+
+		return 0;
+	}
+
 	n = blk_dwrite(desc, blk_start, blk_cnt, (u_char *)buffer);
 
 	return (n == blk_cnt) ? 0 : -1;
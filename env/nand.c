@@ -156,6 +156,86 @@ static int writeenv(size_t offset, u_char *buf)
 	return 0;
 }
 
+struct env_nand_priv {
+	struct mtd_info *mtd;
+	size_t offset;
+};
+
+/* Find the @unit'th good block of the environment, skipping bad blocks */
+static int env_nand_block(struct env_nand_priv *p, uint unit, size_t *blockp)
+{
+	size_t end = p->offset + CONFIG_ENV_RANGE;
+	size_t offset;
+
+	for (offset = p->offset; offset < end; offset += p->mtd->erasesize) {
+		if (nand_block_isbad(p->mtd, offset))
+			continue;
+		if (!unit--) {
+			*blockp = offset;
+			return 0;
+		}
+	}
+
+	return -ENOSPC;
+}
+
+/*
+ * Each unit is the part of the environment held in one good erase block,
+ * i.e. min(erasesize, CONFIG_ENV_SIZE) bytes
+ */
+static int env_nand_read_blocks(void *priv, uint unit, uint count, uint len,
+				void *buf)
+{
+	struct env_nand_priv *p = priv;
+	size_t blocksize = p->mtd->erasesize;
+	size_t block, rwlen;
+	u_char *ptr = buf;
+	int ret;
+
+	for (; count; count--, unit++) {
+		ret = env_nand_block(p, unit, &block);
+		if (ret)
+			return ret;
+		rwlen = min(blocksize, (size_t)len);
+		if (nand_read(p->mtd, block, &rwlen, ptr))
+			return -EIO;
+		ptr += rwlen;
+		len -= rwlen;
+	}
+
+	return 0;
+}
+
+static int env_nand_write_blocks(void *priv, uint unit, uint count, uint len,
+				 const void *buf)
+{
+	struct env_nand_priv *p = priv;
+	size_t blocksize = p->mtd->erasesize;
+	const u_char *ptr = buf;
+	size_t block, rwlen;
+	int ret;
+
+	for (; count; count--, unit++) {
+		ret = env_nand_block(p, unit, &block);
+		if (ret)
+			return ret;
+		if (nand_erase(p->mtd, block, blocksize))
+			return -EIO;
+		rwlen = min(blocksize, (size_t)len);
+		if (nand_write(p->mtd, block, &rwlen, (u_char *)ptr))
+			return -EIO;
+		ptr += rwlen;
+		len -= rwlen;
+	}
+
+	return 0;
+}
+
+static const struct env_write_ops env_nand_ops = {
+	.read	= env_nand_read_blocks,
+	.write	= env_nand_write_blocks,
+};
+
 struct nand_env_location {
 	const char *name;
 	const nand_erase_options_t erase_opts;
@@ -171,6 +251,24 @@ static int erase_and_write_env(const struct nand_env_location *location,
 	if (!mtd)
 		return 1;
 
+	if (IS_ENABLED(CONFIG_ENV_INCREMENTAL_SAVE)) {
+		struct env_nand_priv priv = { mtd, location->erase_opts.offset };
+		size_t len = min_t(size_t, mtd->erasesize, CONFIG_ENV_SIZE);
+
+		/* Only the erase blocks which differ are written */
+		printf("Updating %s... ", location->name);
+		ret = env_write_changed(&env_nand_ops, &priv, env_new,
+					CONFIG_ENV_SIZE, len);
+		if (ret < 0) {
+			puts("FAILED!\n");
+			return 1;
+		}
+		printf("%d of %d blocks written\n", ret,
+		       (int)DIV_ROUND_UP(CONFIG_ENV_SIZE, len));
+
+		return 0;
+	}
+
 	printf("Erasing %s...\n", location->name);
 	if (nand_erase_opts(mtd, &location->erase_opts))
 		return 1;
@@ -81,43 +81,90 @@ static int setup_flash_device(void)
 	return 0;
 }
 
-#if defined(CONFIG_ENV_OFFSET_REDUND)
 #ifdef CMD_SAVEENV
-static int env_sf_save(void)
+#ifdef CONFIG_ENV_INCREMENTAL_SAVE
+static int env_sf_read_sectors(void *priv, uint sector, uint count, uint len,
+			       void *buf)
 {
-	env_t	env_new;
-	char	*saved_buffer = NULL, flag = OBSOLETE_FLAG;
-	u32	saved_size, saved_offset, sector;
-	int	ret;
+	u32 offset = *(u32 *)priv + sector * CONFIG_ENV_SECT_SIZE;
 
-	ret = setup_flash_device();
-	if (ret)
-		return ret;
+	return spi_flash_read(env_flash, offset, len, buf);
+}
 
-	ret = env_export(&env_new);
-	if (ret)
-		return -EIO;
-	env_new.flags	= ACTIVE_FLAG;
+static int env_sf_write_sectors(void *priv, uint sector, uint count,
+				uint len, const void *buf)
+{
+	u32	offset = *(u32 *)priv + sector * CONFIG_ENV_SECT_SIZE;
+	u32	size = count * CONFIG_ENV_SECT_SIZE;
+	char	*saved_buffer = NULL;
+	int	ret;
 
-	if (gd->env_valid == ENV_VALID) {
-		env_new_offset = CONFIG_ENV_OFFSET_REDUND;
-		env_offset = CONFIG_ENV_OFFSET;
-	} else {
-		env_new_offset = CONFIG_ENV_OFFSET;
-		env_offset = CONFIG_ENV_OFFSET_REDUND;
+	/* Anything after the environment in the last sector is kept */
+	if (len < size) {
+		saved_buffer = memalign(ARCH_DMA_MINALIGN, size - len);
+		if (!saved_buffer)
+			return -ENOMEM;
+
+		ret = spi_flash_read(env_flash, offset + len, size - len,
+				     saved_buffer);
+		if (ret)
+			goto done;
 	}
 
+	ret = spi_flash_erase(env_flash, offset, size);
+	if (!ret)
+		ret = spi_flash_write(env_flash, offset, len, buf);
+	if (!ret && saved_buffer)
+		ret = spi_flash_write(env_flash, offset + len, size - len,
+				      saved_buffer);
+
+ done:
+	free(saved_buffer);
+
+	return ret;
+}
+
+static const struct env_write_ops env_sf_ops = {
+	.read	= env_sf_read_sectors,
+	.write	= env_sf_write_sectors,
+};
+
+/*
+ * Write the environment at @offset, erasing and writing only the sectors
+ * which differ from what is in flash
+ */
+static int env_sf_write(u32 offset, env_t *env)
+{
+	int	ret;
+
+	puts("Updating SPI flash...");
+	ret = env_write_changed(&env_sf_ops, &offset, env, CONFIG_ENV_SIZE,
+				CONFIG_ENV_SECT_SIZE);
+	if (ret < 0)
+		return ret;
+	printf("%d of %d sectors written...", ret,
+	       (int)DIV_ROUND_UP(CONFIG_ENV_SIZE, CONFIG_ENV_SECT_SIZE));
+
+	return 0;
+}
+#else
+/* Erase the sectors at @offset and write the environment there */
+static int env_sf_write(u32 offset, env_t *env)
+{
+	u32	saved_size, saved_offset, sector;
+	char	*saved_buffer = NULL;
+	int	ret;
+
 	/* Is the sector larger than the env (i.e. embedded) */
 	if (CONFIG_ENV_SECT_SIZE > CONFIG_ENV_SIZE) {
 		saved_size = CONFIG_ENV_SECT_SIZE - CONFIG_ENV_SIZE;
-		saved_offset = env_new_offset + CONFIG_ENV_SIZE;
+		saved_offset = offset + CONFIG_ENV_SIZE;
 		saved_buffer = memalign(ARCH_DMA_MINALIGN, saved_size);
-		if (!saved_buffer) {
-			ret = -ENOMEM;
-			goto done;
-		}
+		if (!saved_buffer)
+			return -ENOMEM;
+
 		ret = spi_flash_read(env_flash, saved_offset,
-					saved_size, saved_buffer);
+				     saved_size, saved_buffer);
 		if (ret)
 			goto done;
 	}
@@ -125,29 +172,61 @@ static int env_sf_save(void)
 	sector = DIV_ROUND_UP(CONFIG_ENV_SIZE, CONFIG_ENV_SECT_SIZE);
 
 	puts("Erasing SPI flash...");
-	ret = spi_flash_erase(env_flash, env_new_offset,
-				sector * CONFIG_ENV_SECT_SIZE);
+	ret = spi_flash_erase(env_flash, offset,
+			      sector * CONFIG_ENV_SECT_SIZE);
 	if (ret)
 		goto done;
 
 	puts("Writing to SPI flash...");
-
-	ret = spi_flash_write(env_flash, env_new_offset,
-		CONFIG_ENV_SIZE, &env_new);
+	ret = spi_flash_write(env_flash, offset, CONFIG_ENV_SIZE, env);
 	if (ret)
 		goto done;
 
-	if (CONFIG_ENV_SECT_SIZE > CONFIG_ENV_SIZE) {
+	if (CONFIG_ENV_SECT_SIZE > CONFIG_ENV_SIZE)
 		ret = spi_flash_write(env_flash, saved_offset,
-					saved_size, saved_buffer);
-		if (ret)
-			goto done;
+				      saved_size, saved_buffer);
+
+ done:
+	free(saved_buffer);
+
+	return ret;
+}
+#endif /* CONFIG_ENV_INCREMENTAL_SAVE */
+#endif /* CMD_SAVEENV */
+
+#if defined(CONFIG_ENV_OFFSET_REDUND)
+#ifdef CMD_SAVEENV
+static int env_sf_save(void)
+{
+	env_t	env_new;
+	char	flag = OBSOLETE_FLAG;
+	int	ret;
+
+	ret = setup_flash_device();
+	if (ret)
+		return ret;
+
+	ret = env_export(&env_new);
+	if (ret)
+		return -EIO;
+	env_new.flags	= ACTIVE_FLAG;
+
+	if (gd->env_valid == ENV_VALID) {
+		env_new_offset = CONFIG_ENV_OFFSET_REDUND;
+		env_offset = CONFIG_ENV_OFFSET;
+	} else {
+		env_new_offset = CONFIG_ENV_OFFSET;
+		env_offset = CONFIG_ENV_OFFSET_REDUND;
 	}
 
+	ret = env_sf_write(env_new_offset, &env_new);
+	if (ret)
+		return ret;
+
 	ret = spi_flash_write(env_flash, env_offset + offsetof(env_t, flags),
 				sizeof(env_new.flags), &flag);
 	if (ret)
-		goto done;
+		return ret;
 
 	puts("done\n");
 
@@ -155,11 +234,7 @@ static int env_sf_save(void)
 
 	printf("Valid environment: %d\n", (int)gd->env_valid);
 
- done:
-	if (saved_buffer)
-		free(saved_buffer);
-
-	return ret;
+	return 0;
 }
 #endif /* CMD_SAVEENV */
 
@@ -203,62 +278,24 @@ out:
 #ifdef CMD_SAVEENV
 static int env_sf_save(void)
 {
-	u32	saved_size, saved_offset, sector;
-	char	*saved_buffer = NULL;
-	int	ret = 1;
 	env_t	env_new;
+	int	ret;
 
 	ret = setup_flash_device();
 	if (ret)
 		return ret;
 
-	/* Is the sector larger than the env (i.e. embedded) */
-	if (CONFIG_ENV_SECT_SIZE > CONFIG_ENV_SIZE) {
-		saved_size = CONFIG_ENV_SECT_SIZE - CONFIG_ENV_SIZE;
-		saved_offset = CONFIG_ENV_OFFSET + CONFIG_ENV_SIZE;
-		saved_buffer = malloc(saved_size);
-		if (!saved_buffer)
-			goto done;
-
-		ret = spi_flash_read(env_flash, saved_offset,
-			saved_size, saved_buffer);
-		if (ret)
-			goto done;
-	}
-
 	ret = env_export(&env_new);
 	if (ret)
-		goto done;
-
-	sector = DIV_ROUND_UP(CONFIG_ENV_SIZE, CONFIG_ENV_SECT_SIZE);
-
-	puts("Erasing SPI flash...");
-	ret = spi_flash_erase(env_flash, CONFIG_ENV_OFFSET,
-		sector * CONFIG_ENV_SECT_SIZE);
-	if (ret)
-		goto done;
+		return ret;
 
-	puts("Writing to SPI flash...");
-	ret = spi_flash_write(env_flash, CONFIG_ENV_OFFSET,
-		CONFIG_ENV_SIZE, &env_new);
+	ret = env_sf_write(CONFIG_ENV_OFFSET, &env_new);
 	if (ret)
-		goto done;
-
-	if (CONFIG_ENV_SECT_SIZE > CONFIG_ENV_SIZE) {
-		ret = spi_flash_write(env_flash, saved_offset,
-			saved_size, saved_buffer);
-		if (ret)
-			goto done;
-	}
+		return ret;
 
-	ret = 0;
 	puts("done\n");
 
- done:
-	if (saved_buffer)
-		free(saved_buffer);
-
-	return ret;
+	return 0;
 }
 #endif /* CMD_SAVEENV */
 
@@ -1956,6 +1956,202 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 	return blknr;
 }
 
+/*
+ * Cache of the block runs of the file being read, so that reading a large
+ * file does not descend the extent tree or walk the indirect blocks again for
+ * every file block. Runs are kept sorted by file block.
+ */
+#define EXT4_RUN_CACHE_MAX	1024
+
+struct ext4_block_run {
+	long int fileblock;	/* First file block of the run */
+	long int blknr;		/* First filesystem block, 0 for a hole */
+	long int count;		/* Number of blocks in the run */
+};
+
+static struct {
+	struct ext2_data *data;
+	int ino;
+	int count;
+	int size;
+	struct ext4_block_run *runs;
+} ext4fs_run_cache;
+
+static void ext4fs_run_cache_reset(void)
+{
+	free(ext4fs_run_cache.runs);
+	memset(&ext4fs_run_cache, 0, sizeof(ext4fs_run_cache));
+}
+
+/* Return the index of the first run ending after 'fileblock' */
+static int ext4fs_run_cache_find(long int fileblock)
+{
+	struct ext4_block_run *runs = ext4fs_run_cache.runs;
+	int lo = 0, hi = ext4fs_run_cache.count;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (runs[mid].fileblock + runs[mid].count <= fileblock)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static void ext4fs_run_cache_add(long int fileblock, long int blknr,
+				 long int count)
+{
+	struct ext4_block_run *run;
+	int idx;
+
+	idx = ext4fs_run_cache_find(fileblock);
+	if (idx < ext4fs_run_cache.count) {
+		run = &ext4fs_run_cache.runs[idx];
+		/* Already cached */
+		if (run->fileblock <= fileblock)
+			return;
+		/* Do not overlap the next run */
+		if (fileblock + count > run->fileblock)
+			count = run->fileblock - fileblock;
+	}
+
+	if (ext4fs_run_cache.count == EXT4_RUN_CACHE_MAX)
+		return;
+
+	if (ext4fs_run_cache.count == ext4fs_run_cache.size) {
+		int size = ext4fs_run_cache.size ? ext4fs_run_cache.size * 2 :
+			   16;
+
+		run = realloc(ext4fs_run_cache.runs, size * sizeof(*run));
+		if (!run)
+			return;
+		ext4fs_run_cache.runs = run;
+		ext4fs_run_cache.size = size;
+	}
+
+	run = &ext4fs_run_cache.runs[idx];
+	memmove(run + 1, run, (ext4fs_run_cache.count - idx) * sizeof(*run));
+	run->fileblock = fileblock;
+	run->blknr = blknr;
+	run->count = count;
+	ext4fs_run_cache.count++;
+}
+
+/*
+ * Add all extents of the leaf covering 'fileblock' to the run cache. If
+ * 'fileblock' falls in a hole, add the hole up to the next extent.
+ */
+static int ext4fs_map_extents(struct ext2fs_node *node, long int fileblock)
+{
+	struct ext4_extent_header *ext_block;
+	struct ext4_extent *extent;
+	long int startblock, count;
+	long int hole_end = fileblock + 1;
+	unsigned long long start;
+	int log2_blksz;
+	char *buf;
+	int i;
+
+	log2_blksz = LOG2_BLOCK_SIZE(node->data) -
+		get_fs()->dev_desc->log2blksz;
+	buf = zalloc(EXT2_BLOCK_SIZE(node->data));
+	if (!buf)
+		return -ENOMEM;
+
+	ext_block = ext4fs_get_extent_block(node->data, buf,
+					    (struct ext4_extent_header *)
+					    node->inode.b.blocks.dir_blocks,
+					    fileblock, log2_blksz);
+	if (!ext_block) {
+		printf("invalid extent block\n");
+		free(buf);
+		return -EINVAL;
+	}
+
+	extent = (struct ext4_extent *)(ext_block + 1);
+	for (i = 0; i < le16_to_cpu(ext_block->eh_entries); i++) {
+		startblock = le32_to_cpu(extent[i].ee_block);
+		count = le16_to_cpu(extent[i].ee_len);
+		start = le16_to_cpu(extent[i].ee_start_hi);
+		start = (start << 32) + le32_to_cpu(extent[i].ee_start_lo);
+
+		if (startblock > fileblock && hole_end == fileblock + 1)
+			hole_end = startblock;
+		if (count)
+			ext4fs_run_cache_add(startblock, start, count);
+	}
+	free(buf);
+
+	/* Sparse file */
+	ext4fs_run_cache_add(fileblock, 0, hole_end - fileblock);
+
+	return 0;
+}
+
+/**
+ * ext4fs_map_blocks() - map file blocks to a run of filesystem blocks
+ *
+ * @node:	file to map
+ * @fileblock:	first file block
+ * @maxblocks:	maximum number of blocks to map
+ * @count:	returns the number of contiguous blocks mapped, at least 1
+ * @return first filesystem block, 0 for a hole, or a negative value on error
+ */
+long int ext4fs_map_blocks(struct ext2fs_node *node, long int fileblock,
+			   long int maxblocks, long int *count)
+{
+	struct ext4_block_run *run;
+	long int blknr, next;
+	int idx;
+
+	if (ext4fs_run_cache.data != node->data ||
+	    ext4fs_run_cache.ino != node->ino) {
+		ext4fs_run_cache_reset();
+		ext4fs_run_cache.data = node->data;
+		ext4fs_run_cache.ino = node->ino;
+	}
+
+	idx = ext4fs_run_cache_find(fileblock);
+	if (idx == ext4fs_run_cache.count ||
+	    ext4fs_run_cache.runs[idx].fileblock > fileblock) {
+		if (le32_to_cpu(node->inode.flags) & EXT4_EXTENTS_FL) {
+			if (ext4fs_map_extents(node, fileblock))
+				return -1;
+		} else {
+			/* Collect consecutive blocks through the indirect blocks */
+			blknr = read_allocated_block(&node->inode, fileblock);
+			if (blknr < 0)
+				return -1;
+			for (*count = 1; *count < maxblocks; (*count)++) {
+				next = read_allocated_block(&node->inode,
+							    fileblock + *count);
+				if (next < 0 ||
+				    next != (blknr ? blknr + *count : 0))
+					break;
+			}
+			ext4fs_run_cache_add(fileblock, blknr, *count);
+		}
+		idx = ext4fs_run_cache_find(fileblock);
+	}
+
+	if (idx == ext4fs_run_cache.count ||
+	    ext4fs_run_cache.runs[idx].fileblock > fileblock) {
+		/* The cache is full, map a single block */
+		*count = 1;
+		return read_allocated_block(&node->inode, fileblock);
+	}
+
+	run = &ext4fs_run_cache.runs[idx];
+	*count = run->count - (fileblock - run->fileblock);
+	if (*count > maxblocks)
+		*count = maxblocks;
+
+	return run->blknr ? run->blknr + (fileblock - run->fileblock) : 0;
+}
+
 /**
  * ext4fs_reinit_global() - Reinitialize values of ext4 write implementation's
  *			    global pointers
@@ -1988,6 +2184,7 @@ void ext4fs_reinit_global(void)
 		ext4fs_indir3_size = 0;
 		ext4fs_indir3_blkno = -1;
 	}
+	ext4fs_run_cache_reset();
 }
 void ext4fs_close(void)
 {
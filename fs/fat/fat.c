@@ -20,6 +20,7 @@
 #include <memalign.h>
 #include <linux/compiler.h>
 #include <linux/ctype.h>
+#include <linux/math64.h>
 
 /*
  * Convert a string to lowercase.  Converts at most 'len' characters,
@@ -37,6 +38,49 @@ static void downcase(char *str, size_t len)
 static struct blk_desc *cur_dev;
 static disk_partition_t cur_part_info;
 
+#if !CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE)
+/*
+ * Extent map of the most recently read file. Runs of contiguous clusters
+ * are merged into a single extent, so that get_contents() can read each run
+ * with one disk access and seek within the file without walking the FAT
+ * chain again.
+ *
+ * The map grows with realloc(), so it needs the full malloc(). With the
+ * simple malloc(), get_contents() walks the FAT chain for each read.
+ */
+struct fat_extent {
+	__u32 clust;	/* First cluster of the run */
+	__u32 count;	/* Number of clusters in the run */
+};
+
+#define FAT_EXTMAP_BPB_SIZE	0x5a	/* Boot sector bytes up to the FS type */
+
+static struct {
+	struct blk_desc *dev;
+	lbaint_t part_start;
+	__u8 bpb[FAT_EXTMAP_BPB_SIZE];	/* Identifies the filesystem */
+	__u32 start;		/* First cluster of the file, 0 if unused */
+	__u32 last;		/* Last cluster mapped */
+	__u32 nr_clust;		/* Number of clusters mapped */
+	int complete;		/* Set if the end of the chain was reached */
+	int count;		/* Number of extents in use */
+	int size;		/* Number of extents allocated */
+	struct fat_extent *ext;
+} fat_extmap;
+
+static void fat_extmap_invalidate(void)
+{
+	fat_extmap.start = 0;
+	fat_extmap.nr_clust = 0;
+	fat_extmap.complete = 0;
+	fat_extmap.count = 0;
+}
+#else
+static inline void fat_extmap_invalidate(void)
+{
+}
+#endif
+
 #define DOS_BOOT_MAGIC_OFFSET	0x1fe
 #define DOS_FS_TYPE_OFFSET	0x36
 #define DOS_FS32_TYPE_OFFSET	0x52
@@ -69,6 +113,18 @@ int fat_set_blk_dev(struct blk_desc *dev_desc, disk_partition_t *info)
 		return -1;
 	}
 
+#if !CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE)
+	/* Keep the extent map only if this is still the same filesystem */
+	if (fat_extmap.dev != cur_dev ||
+	    fat_extmap.part_start != cur_part_info.start ||
+	    memcmp(fat_extmap.bpb, buffer, FAT_EXTMAP_BPB_SIZE)) {
+		fat_extmap_invalidate();
+		fat_extmap.dev = cur_dev;
+		fat_extmap.part_start = cur_part_info.start;
+		memcpy(fat_extmap.bpb, buffer, FAT_EXTMAP_BPB_SIZE);
+	}
+#endif
+
 	/* Check if it's actually a DOS volume */
 	if (memcmp(buffer + DOS_BOOT_MAGIC_OFFSET, "\x55\xAA", 2)) {
 		cur_dev = NULL;
@@ -300,14 +356,172 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 	return 0;
 }
 
+__u8 get_contents_vfatname_block[MAX_CLUSTSIZE]
+	__aligned(ARCH_DMA_MINALIGN);
+
+#if !CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE)
+static int fat_extmap_add(__u32 clust)
+{
+	struct fat_extent *ext;
+	int size;
+
+	if (fat_extmap.count) {
+		ext = &fat_extmap.ext[fat_extmap.count - 1];
+		if (ext->clust + ext->count == clust) {
+			ext->count++;
+			return 0;
+		}
+	}
+
+	if (fat_extmap.count == fat_extmap.size) {
+		size = fat_extmap.size ? fat_extmap.size * 2 : 16;
+		ext = realloc(fat_extmap.ext, size * sizeof(*ext));
+		if (!ext)
+			return -ENOMEM;
+		fat_extmap.ext = ext;
+		fat_extmap.size = size;
+	}
+
+	ext = &fat_extmap.ext[fat_extmap.count++];
+	ext->clust = clust;
+	ext->count = 1;
+
+	return 0;
+}
+
+/*
+ * Make sure the extent map covers the first 'nclust' clusters of the chain
+ * starting at 'start', extending the current map if it is for the same file.
+ * fat_set_blk_dev() drops the map when a different filesystem is selected.
+ * The map ends early if the chain is shorter than that.
+ * Return 0 on success, -1 otherwise.
+ */
+static int fat_extmap_build(fsdata *mydata, __u32 start, __u32 nclust)
+{
+	__u32 clust;
+
+	if (!fat_extmap.count || fat_extmap.start != start ||
+	    fat_extmap.dev != cur_dev) {
+		fat_extmap_invalidate();
+		if (fat_extmap_add(start))
+			return -1;
+		fat_extmap.start = start;
+		fat_extmap.last = start;
+		fat_extmap.nr_clust = 1;
+	}
+
+	while (fat_extmap.nr_clust < nclust && !fat_extmap.complete) {
+		clust = get_fatent(mydata, fat_extmap.last);
+		if (CHECK_CLUST(clust, mydata->fatsize)) {
+			debug("curclust: 0x%x\n", clust);
+			debug("Invalid FAT entry\n");
+			fat_extmap.complete = 1;
+			break;
+		}
+		if (fat_extmap_add(clust)) {
+			fat_extmap_invalidate();
+			return -1;
+		}
+		fat_extmap.last = clust;
+		fat_extmap.nr_clust++;
+	}
+
+	debug("FAT extent map: %u clusters in %d extents\n",
+	      fat_extmap.nr_clust, fat_extmap.count);
+
+	return 0;
+}
+
 /*
  * Read at most 'maxsize' bytes from 'pos' in the file associated with 'dentptr'
  * into 'buffer'.
  * Update the number of bytes read in *gotsize or return -1 on fatal errors.
  */
-__u8 get_contents_vfatname_block[MAX_CLUSTSIZE]
-	__aligned(ARCH_DMA_MINALIGN);
+static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
+			__u8 *buffer, loff_t maxsize, loff_t *gotsize)
+{
+	loff_t filesize = FAT2CPU32(dentptr->size);
+	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
+	struct fat_extent *ext;
+	__u32 clustidx, offset, clust;
+	loff_t actsize, runsize;
+	int i;
+
+	*gotsize = 0;
+	debug("Filesize: %llu bytes\n", filesize);
+
+	if (pos >= filesize) {
+		debug("Read position past EOF: %llu\n", pos);
+		return 0;
+	}
+
+	if (maxsize > 0 && filesize > pos + maxsize)
+		filesize = pos + maxsize;
+
+	debug("%llu bytes\n", filesize);
+
+	if (fat_extmap_build(mydata, START(dentptr),
+			     div_u64(filesize + bytesperclust - 1,
+				     bytesperclust))) {
+		printf("Error mapping clusters\n");
+		return -1;
+	}
+
+	/* find the cluster at pos */
+	clustidx = div_u64_rem(pos, bytesperclust, &offset);
+	filesize -= pos;
+
+	for (i = 0, ext = fat_extmap.ext; i < fat_extmap.count && filesize;
+	     i++, ext++) {
+		if (clustidx >= ext->count) {
+			clustidx -= ext->count;
+			continue;
+		}
+		clust = ext->clust + clustidx;
+		runsize = (loff_t)(ext->count - clustidx) * bytesperclust;
+		clustidx = 0;
+
+		/* read up to the beginning of the next cluster if any */
+		if (offset) {
+			actsize = min(filesize + offset, (loff_t)bytesperclust);
+			if (get_cluster(mydata, clust,
+					get_contents_vfatname_block,
+					(int)actsize) != 0) {
+				printf("Error reading cluster\n");
+				return -1;
+			}
+			actsize -= offset;
+			memcpy(buffer, get_contents_vfatname_block + offset,
+			       actsize);
+			*gotsize += actsize;
+			buffer += actsize;
+			filesize -= actsize;
+			offset = 0;
+
+			clust++;
+			runsize -= bytesperclust;
+			if (!runsize || !filesize)
+				continue;
+		}
+
+		/* read the rest of the run in one go */
+		actsize = min(filesize, runsize);
+		if (get_cluster(mydata, clust, buffer, (int)actsize) != 0) {
+			printf("Error reading cluster\n");
+			return -1;
+		}
+		*gotsize += actsize;
+		buffer += actsize;
+		filesize -= actsize;
+	}
+
+	if (filesize)
+		debug("Cluster chain ends before end of file\n");
 
+	return 0;
+}
+#else
+/* As above, but walk the FAT chain instead of using the extent map */
 static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 			__u8 *buffer, loff_t maxsize, loff_t *gotsize)
 {
@@ -417,6 +631,7 @@ getit:
 		endclust = curclust;
 	} while (1);
 }
+#endif
 
 /*
  * Extract the file name information from 'slotptr' into 'l_name',
@@ -115,6 +115,9 @@ static int flush_dirty_fat_buffer(fsdata *mydata)
 	if ((!mydata->fat_dirty) || (mydata->fatbufnum == -1))
 		return 0;
 
+	/* Cluster chains may have changed */
+	fat_extmap_invalidate();
+
 	/* Cap length if fatlength is not a multiple of FATBUFBLOCKS */
 	if (startblock + getsize > fatlength)
 		getsize = fatlength - startblock;
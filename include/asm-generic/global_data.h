@@ -66,6 +66,12 @@ typedef struct global_data {
 	struct udevice	*dm_root;	/* Root instance for Driver Model */
 	struct udevice	*dm_root_f;	/* Pre-relocation root instance */
 	struct list_head uclass_root;	/* Head of core tree */
+#if CONFIG_IS_ENABLED(DM_COMPAT_HASH)
+	struct lists_compat *dm_compat;	/* Drivers by compatible string */
+#endif
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+	struct lists_pending *dm_pending; /* Nodes waiting to be bound */
+#endif
 #endif
 #ifdef CONFIG_TIMER
 	struct udevice	*timer;		/* Timer instance for Driver Model */
@@ -74,6 +80,9 @@ typedef struct global_data {
 	const void *fdt_blob;		/* Our device tree, NULL if none */
 	void *new_fdt;			/* Relocated FDT */
 	unsigned long fdt_size;		/* Space reserved for relocated FDT */
+#if CONFIG_IS_ENABLED(OF_LIBFDT_CACHE)
+	struct fdt_caches *fdt_cache;	/* Phandle and path lookup caches */
+#endif
 #ifdef CONFIG_OF_LIVE
 	struct device_node *of_root;
 #endif
@@ -128,6 +128,25 @@ int blkcache_read(int iftype, int dev,
 		  lbaint_t start, lbaint_t blkcnt,
 		  unsigned long blksz, void *buffer);
 
+/**
+ * blkcache_readahead() - work out how many blocks to read after a cache miss
+ *
+ * This should be called after blkcache_read() returns 0. If the read
+ * continues a sequential access pattern, the caller should read the
+ * returned number of blocks and pass them all to blkcache_fill(), so that
+ * following reads are served from the cache.
+ *
+ * @param iftype - IF_TYPE_x for type of device
+ * @param dev - device index of particular type
+ * @param start - starting block number
+ * @param blkcnt - number of blocks requested
+ * @param lba - number of blocks on the device
+ *
+ * @return - number of blocks to read from @start, at least @blkcnt
+ */
+lbaint_t blkcache_readahead(int iftype, int dev,
+			    lbaint_t start, lbaint_t blkcnt, lbaint_t lba);
+
 /**
  * blkcache_fill() - make data read from a block device available
  * to the block cache
@@ -156,10 +175,11 @@ void blkcache_invalidate(int iftype, int dev);
 /**
  * blkcache_configure() - configure block cache
  *
- * @param blocks - maximum blocks per entry
- * @param entries - maximum entries in cache
+ * @param blocks - maximum blocks per read request to cache
+ * @param entries - maximum number of blocks in cache
+ * @param readahead - blocks to read ahead on a sequential miss (0 = off)
  */
-void blkcache_configure(unsigned blocks, unsigned entries);
+void blkcache_configure(unsigned blocks, unsigned entries, unsigned readahead);
 
 /*
  * statistics of the block cache
@@ -167,9 +187,11 @@ void blkcache_configure(unsigned blocks, unsigned entries);
 struct block_cache_stats {
 	unsigned hits;
 	unsigned misses;
-	unsigned entries; /* current entry count */
+	unsigned readahead; /* blocks read ahead */
+	unsigned entries; /* current entry (block) count */
 	unsigned max_blocks_per_entry;
 	unsigned max_entries;
+	unsigned max_readahead;
 };
 
 /**
@@ -188,6 +210,13 @@ static inline int blkcache_read(int iftype, int dev,
 	return 0;
 }
 
+static inline lbaint_t blkcache_readahead(int iftype, int dev,
+					  lbaint_t start, lbaint_t blkcnt,
+					  lbaint_t lba)
+{
+	return blkcnt;
+}
+
 static inline void blkcache_fill(int iftype, int dev,
 				 lbaint_t start, lbaint_t blkcnt,
 				 unsigned long blksz, void const *buffer) {}
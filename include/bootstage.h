@@ -307,6 +307,35 @@ uint32_t bootstage_accum(enum bootstage_id id);
 /* Print a report about boot time */
 void bootstage_report(void);
 
+/**
+ * bootstage_initcall() - Record the time taken by an init function
+ *
+ * This is called by initcall_run_list() for each function it calls. The
+ * timing is dropped if bootstage is not set up yet.
+ *
+ * @addr:	Link-time address of the function
+ * @start_us:	Time when the function was called, in microseconds
+ * @time_us:	Time taken by the function in microseconds
+ */
+void bootstage_initcall(ulong addr, uint32_t start_us, uint32_t time_us);
+
+/* Print the time taken by each init function, slowest first */
+void bootstage_report_initcalls(void);
+
+/**
+ * bootstage_list_stages() - Write bootstage records for the profile output
+ *
+ * This writes a TRACE_CHUNK_STAGES chunk, so that boot stages and init
+ * functions can be shown with the function trace. See struct
+ * trace_output_stage for the format.
+ *
+ * @buff:	Buffer in which to place data, or NULL to count size
+ * @buff_size:	Size of buffer
+ * @needed:	Returns number of bytes used / needed
+ * @return 0 if ok, -ENOSPC if the buffer was too small
+ */
+int bootstage_list_stages(void *buff, int buff_size, unsigned int *needed);
+
 /**
  * Add bootstage information to the device tree
  *
@@ -403,6 +432,11 @@ static inline uint32_t bootstage_accum(enum bootstage_id id)
 	return 0;
 }
 
+static inline void bootstage_initcall(ulong addr, uint32_t start_us,
+				      uint32_t time_us)
+{
+}
+
 static inline int bootstage_stash(void *base, int size)
 {
 	return 0;	/* Pretend to succeed */
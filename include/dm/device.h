@@ -21,6 +21,14 @@
 
 struct driver_info;
 
+/* Keys by which a uclass indexes its devices (CONFIG_DM_UCLASS_INDEX) */
+enum {
+	DM_INDEX_SEQ,		/* dev->seq, for active devices */
+	DM_INDEX_NODE,		/* dev->node, for devices with a valid node */
+
+	DM_INDEX_COUNT,
+};
+
 /* Driver is active (probed). Cleared when it is removed */
 #define DM_FLAG_ACTIVATED		(1 << 0)
 
@@ -123,6 +131,8 @@ enum {
  *		When CONFIG_DEVRES is enabled, devm_kmalloc() and friends will
  *		add to this list. Memory so-allocated will be freed
  *		automatically when the device is removed / unbound
+ * @index_next: Next device in each of the uclass's lookup hash chains, when
+ *		CONFIG_DM_UCLASS_INDEX is enabled
  */
 struct udevice {
 	const struct driver *driver;
@@ -146,6 +156,9 @@ struct udevice {
 #ifdef CONFIG_DEVRES
 	struct list_head devres_head;
 #endif
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	struct udevice *index_next[DM_INDEX_COUNT];
+#endif
 };
 
 /* Maximum sequence number supported */
@@ -162,9 +175,20 @@ static inline int dev_of_offset(const struct udevice *dev)
 	return ofnode_to_offset(dev->node);
 }
 
+/**
+ * dev_set_ofnode() - set the device tree node of a device
+ *
+ * This keeps the uclass's index of devices by node up to date, so should be
+ * used instead of writing to dev->node once the device is bound.
+ *
+ * @dev:	Device to update
+ * @node:	New device tree node
+ */
+void dev_set_ofnode(struct udevice *dev, ofnode node);
+
 static inline void dev_set_of_offset(struct udevice *dev, int of_offset)
 {
-	dev->node = offset_to_ofnode(of_offset);
+	dev_set_ofnode(dev, offset_to_ofnode(of_offset));
 }
 
 static inline bool dev_has_of_node(struct udevice *dev)
@@ -58,6 +58,95 @@ int lists_bind_drivers(struct udevice *parent, bool pre_reloc_only);
  */
 int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp);
 
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+/**
+ * lists_bind_fdt_lazy() - bind a device tree node now or when it is needed
+ *
+ * With CONFIG_DM_LAZY_BIND, while lists_defer_bind() is enabled, a node
+ * which is matched by a driver is only recorded, and is bound by
+ * lists_bind_pending() when its uclass is first used. Nodes are bound
+ * straight away before relocation, if they have subnodes (which the driver
+ * may bind devices for) and if @parent is not the root or a simple bus (which
+ * do not look their children up).
+ *
+ * The devices in each uclass end up in device tree order, as without
+ * CONFIG_DM_LAZY_BIND, so sequence numbers are not affected. Recorded nodes
+ * are added to the end of their parent's list of children when bound.
+ *
+ * @parent: parent device
+ * @node: device tree node to bind
+ * @return 0 if the device was bound or recorded, -ve on error
+ */
+int lists_bind_fdt_lazy(struct udevice *parent, ofnode node);
+
+/**
+ * lists_defer_bind() - start or stop recording device tree nodes
+ *
+ * dm_init_and_scan() enables this for the scan after relocation. Nodes found
+ * at other times, e.g. by the 'bind' command, are bound straight away.
+ *
+ * @defer: true to record nodes in lists_bind_fdt_lazy(), false to bind them
+ */
+void lists_defer_bind(bool defer);
+
+/**
+ * lists_bind_pending() - bind the recorded device tree nodes for a uclass
+ *
+ * The nodes are bound in the order they were recorded, i.e. the device tree
+ * order.
+ *
+ * @id: uclass to bind nodes for
+ * @return 0 if OK (or nothing was pending), -ve on error
+ */
+int lists_bind_pending(enum uclass_id id);
+
+/**
+ * lists_bind_pending_ofnode() - bind a recorded device tree node
+ *
+ * This binds all recorded nodes in the uclass of @node, to keep their order.
+ *
+ * @node: device tree node to bind
+ * @return 0 if OK, -ENOENT if @node was not recorded, other -ve on error
+ */
+int lists_bind_pending_ofnode(ofnode node);
+
+/**
+ * lists_drop_pending() - forget the recorded device tree nodes of a parent
+ *
+ * This must be called when @parent is unbound.
+ *
+ * @parent: parent device, or NULL to forget all recorded nodes
+ */
+void lists_drop_pending(struct udevice *parent);
+#else
+static inline int lists_bind_fdt_lazy(struct udevice *parent, ofnode node)
+{
+	return lists_bind_fdt(parent, node, NULL);
+}
+
+static inline int lists_bind_pending(enum uclass_id id)
+{
+	return 0;
+}
+
+static inline int lists_bind_pending_ofnode(ofnode node)
+{
+	return -ENOENT;
+}
+
+static inline void lists_defer_bind(bool defer) {}
+
+static inline void lists_drop_pending(struct udevice *parent) {}
+#endif
+
+/**
+ * lists_uninit() - free the state kept for binding device tree nodes
+ *
+ * This forgets any recorded nodes and frees the table of compatible strings.
+ * It is called by dm_uninit().
+ */
+void lists_uninit(void);
+
 /**
  * device_bind_driver() - bind a device to a driver
  *
@@ -166,6 +166,36 @@ int uclass_unbind_device(struct udevice *dev);
 static inline int uclass_unbind_device(struct udevice *dev) { return 0; }
 #endif
 
+/**
+ * uclass_index_add() - Add a device to one of its uclass's lookup indexes
+ *
+ * This must be called after the key (see DM_INDEX_...) of a bound device has
+ * changed, e.g. when it is given a sequence number on probe.
+ *
+ * @dev:	Pointer to the device
+ * @index:	Index to update (DM_INDEX_...)
+ */
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+void uclass_index_add(struct udevice *dev, int index);
+#else
+static inline void uclass_index_add(struct udevice *dev, int index) {}
+#endif
+
+/**
+ * uclass_index_del() - Remove a device from one of its uclass's indexes
+ *
+ * This must be called before the key (see DM_INDEX_...) of a bound device is
+ * changed.
+ *
+ * @dev:	Pointer to the device
+ * @index:	Index to update (DM_INDEX_...)
+ */
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+void uclass_index_del(struct udevice *dev, int index);
+#else
+static inline void uclass_index_del(struct udevice *dev, int index) {}
+#endif
+
 /**
  * uclass_pre_probe_device() - Deal with a device that is about to be probed
  *
@@ -30,12 +30,22 @@
  * @dev_head: List of devices in this uclass (devices are attached to their
  * uclass when their bind method is called)
  * @sibling_node: Next uclass in the linked list of uclasses
+ * @index: Hash chains of devices for each of the DM_INDEX_... keys, with
+ * 1 << @index_bits chains per key. This is NULL while the uclass has only a
+ * few devices, which are then found by walking @dev_head.
+ * @index_bits: log2 of the number of hash chains per key
+ * @dev_count: Number of devices bound to this uclass
  */
 struct uclass {
 	void *priv;
 	struct uclass_driver *uc_drv;
 	struct list_head dev_head;
 	struct list_head sibling_node;
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	struct udevice **index;
+	uint index_bits;
+	uint dev_count;
+#endif
 };
 
 struct driver;
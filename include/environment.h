@@ -295,6 +295,47 @@ int env_import(const char *buf, int check);
 /* Export from hash table into binary representation */
 int env_export(env_t *env_out);
 
+/* Record whether the environment matches what is in storage */
+void env_set_stored(bool stored);
+
+/* Check if the environment has changed since it was last loaded or saved */
+bool env_changed(void);
+
+/**
+ * struct env_write_ops - Access to the storage used by env_write_changed()
+ *
+ * Storage is accessed in runs of @count units, starting at unit @unit. The
+ * run holds @len bytes of the environment, which is less than @count units if
+ * the last unit is only partly used.
+ *
+ * @read:	Read a run of units into @buf, which has space for @count whole
+ *		units, returns 0 if OK, -ve on error
+ * @write:	Erase (if needed) and write a run of units from @buf, returns 0
+ *		if OK, -ve on error
+ */
+struct env_write_ops {
+	int (*read)(void *priv, uint unit, uint count, uint len, void *buf);
+	int (*write)(void *priv, uint unit, uint count, uint len,
+		     const void *buf);
+};
+
+/**
+ * env_write_changed() - Write only the parts of the environment which changed
+ *
+ * The environment in storage is read back and only the runs of units (e.g.
+ * SPI flash sectors, NAND erase blocks or MMC blocks) which differ from @buf
+ * are written. If it cannot be read back, all of it is written.
+ *
+ * @ops:	Functions to access the storage
+ * @priv:	Private data passed to @ops
+ * @buf:	Environment to write
+ * @size:	Size of @buf in bytes
+ * @unit_size:	Size of each unit in bytes
+ * @return number of units written, or -ve on error
+ */
+int env_write_changed(const struct env_write_ops *ops, void *priv,
+		      const void *buf, uint size, uint unit_size);
+
 #ifdef CONFIG_SYS_REDUNDAND_ENVIRONMENT
 /* Select and import one of two redundant environments */
 int env_import_redund(const char *buf1, int buf1_status,
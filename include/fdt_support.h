@@ -287,6 +287,7 @@ int fdt_setup_simplefb_node(void *fdt, int node, u64 base_address, u32 width,
 			    u32 height, u32 stride, const char *format);
 
 int fdt_overlay_apply_verbose(void *fdt, void *fdto);
+int fdt_overlay_apply_list_verbose(void *fdt, void * const fdtos[], int count);
 
 /**
  * fdt_get_cells_len() - Get the length of a type of cell in top-level nodes
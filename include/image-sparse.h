@@ -23,6 +23,16 @@ struct sparse_storage {
 				 lbaint_t blk,
 				 lbaint_t blkcnt);
 
+	/*
+	 * Optional: erase @blkcnt blocks from @blk, leaving them reading back
+	 * as zeroes. Only whole groups of erase_blks blocks are passed in, and
+	 * the storage must map blocks linearly (no bad-block skipping).
+	 */
+	lbaint_t	(*erase)(struct sparse_storage *info,
+				 lbaint_t blk,
+				 lbaint_t blkcnt);
+	lbaint_t	erase_blks;
+
 	void		(*mssg)(const char *str, char *response);
 };
 
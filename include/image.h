@@ -56,6 +56,8 @@ struct fdt_region;
 #include <hash.h>
 #include <linux/libfdt.h>
 #include <fdt_support.h>
+#include <u-boot/sha1.h>
+#include <u-boot/sha256.h>
 # ifdef CONFIG_SPL_BUILD
 #  ifdef CONFIG_SPL_CRC32_SUPPORT
 #   define IMAGE_ENABLE_CRC32	1
@@ -296,6 +298,7 @@ enum {
 	IH_COMP_LZMA,			/* lzma  Compression Used	*/
 	IH_COMP_LZO,			/* lzo   Compression Used	*/
 	IH_COMP_LZ4,			/* lz4   Compression Used	*/
+	IH_COMP_ZSTD,			/* zstd  Compression Used	*/
 
 	IH_COMP_COUNT,
 };
@@ -1029,6 +1032,74 @@ int fit_add_verification_data(const char *keydir, void *keydest, void *fit,
 
 int fit_image_verify_with_data(const void *fit, int image_noffset,
 			       const void *data, size_t size);
+
+#define FIT_STREAM_MAX_HASHES	4
+
+/**
+ * struct fit_hash_stream - Progressive check of an image's hash nodes
+ *
+ * This lets a loader which reads the image data in chunks hash each chunk
+ * as it arrives, rather than going over the whole image again once it has
+ * been loaded.
+ *
+ * @fit:		FIT holding the image
+ * @image_noffset:	Offset of the component image node
+ * @count:		Number of hash nodes being calculated
+ * @hash:		One entry for each hash node
+ */
+struct fit_hash_stream {
+	const void *fit;
+	int image_noffset;
+	int count;
+	struct {
+		int noffset;
+		int algo;
+		union {
+			uint32_t crc32;
+			sha1_context sha1;
+			sha256_context sha256;
+		} ctx;
+	} hash[FIT_STREAM_MAX_HASHES];
+};
+
+/**
+ * fit_image_hash_stream_init() - Start hashing an image's data in chunks
+ *
+ * @st:			Stream to set up
+ * @fit:		FIT holding the image
+ * @image_noffset:	Offset of the component image node
+ * @return 0 if OK, -ENOSPC if the image has too many hash nodes, or
+ *	-EPROTONOSUPPORT if one of them uses an algorithm which cannot be
+ *	calculated progressively. The caller should then hash the loaded
+ *	data with fit_image_verify_with_data() instead.
+ */
+int fit_image_hash_stream_init(struct fit_hash_stream *st, const void *fit,
+			       int image_noffset);
+
+/**
+ * fit_image_hash_stream_update() - Hash the next chunk of an image
+ *
+ * @st:		Stream to update
+ * @data:	Next chunk of image data
+ * @size:	Size of the chunk in bytes
+ */
+void fit_image_hash_stream_update(struct fit_hash_stream *st,
+				  const void *data, size_t size);
+
+/**
+ * fit_image_verify_stream() - Verify an image hashed with a stream
+ *
+ * This is the equivalent of fit_image_verify_with_data() for an image
+ * which has been passed through fit_image_hash_stream_update(). Any
+ * signatures are still checked against @data.
+ *
+ * @st:		Stream holding the hashes of the whole image
+ * @data:	Loaded image data
+ * @size:	Size of the image data in bytes
+ * @return 1 if the image is valid, 0 if not
+ */
+int fit_image_verify_stream(struct fit_hash_stream *st, const void *data,
+			    size_t size);
 int fit_image_verify(const void *fit, int noffset);
 int fit_config_verify(const void *fit, int conf_noffset);
 int fit_all_image_verify(const void *fit);
@@ -305,6 +305,106 @@ int fdt_next_region(const void *fdt,
  */
 int fdt_add_alias_regions(const void *fdt, struct fdt_region *region, int count,
 			  int max_regions, struct fdt_region_state *info);
+
+/**
+ * fdt_overlay_apply_list() - Apply a list of overlays to a device tree
+ *
+ * This gives the same result as calling fdt_overlay_apply() for each
+ * overlay in turn, but only walks the base tree once, to build an index of
+ * its phandles and symbols. The base tree must have room for all the
+ * overlays.
+ *
+ * As with fdt_overlay_apply(), the overlays are damaged, as is the base tree
+ * on error.
+ *
+ * @fdt:	Base device tree
+ * @fdtos:	Overlays to apply, in order
+ * @count:	Number of overlays
+ * @return 0 if OK, -ve FDT_ERR_... value on error
+ */
+int fdt_overlay_apply_list(void *fdt, void * const fdtos[], int count);
+
+#ifdef USE_HOSTCC
+#define FDT_LOOKUP_CACHE	0
+#else
+#define FDT_LOOKUP_CACHE	CONFIG_IS_ENABLED(OF_LIBFDT_CACHE)
+#endif
+
+#if FDT_LOOKUP_CACHE
+/**
+ * fdt_cache_phandle() - Look up a phandle in the lookup cache
+ *
+ * This builds an index of all the phandles in @fdt if needed. A cached
+ * offset is checked before it is returned, and the index is rebuilt if
+ * the tree has changed. A phandle which is not in the index is looked for
+ * by walking the tree.
+ *
+ * @fdt:	Device tree to look in
+ * @phandle:	Phandle to look up
+ * @offsetp:	Returns the node offset, or -ve FDT_ERR_... value
+ * @return 1 if *@offsetp was set, 0 if the cache could not be used
+ */
+int fdt_cache_phandle(const void *fdt, uint32_t phandle, int *offsetp);
+
+/**
+ * fdt_cache_path() - Look up a node path in the lookup cache
+ *
+ * @fdt:	Device tree to look in
+ * @path:	Path to look up
+ * @namelen:	Length of @path
+ * @offsetp:	Returns the node offset, or -ve FDT_ERR_... value
+ * @return 1 if *@offsetp was set, 0 if @path is not cached
+ */
+int fdt_cache_path(const void *fdt, const char *path, int namelen,
+		   int *offsetp);
+
+/**
+ * fdt_cache_add_path() - Add the result of a path lookup to the cache
+ *
+ * Only absolute paths of limited length are cached, and only if the node
+ * was found.
+ *
+ * @fdt:	Device tree which was looked in
+ * @path:	Path which was looked up
+ * @namelen:	Length of @path
+ * @offset:	Node offset found, or -ve FDT_ERR_... value
+ */
+void fdt_cache_add_path(const void *fdt, const char *path, int namelen,
+			int offset);
+
+/**
+ * fdt_cache_invalidate() - Drop everything cached for a device tree
+ *
+ * The cache is dropped by itself when the size of the tree changes, but
+ * not all writes do that, e.g. fdt_setprop_inplace(), fdt_nop_node(),
+ * fdt_nop_property() or fdt_set_name() with a name of the same length.
+ * Instead, each entry is checked before it is used: the node at a cached
+ * offset must still have the phandle, or the last component of the path,
+ * that was looked up. This does not notice an in-place rename of a parent
+ * node or nodes moved by writing to the tree directly, so code which does
+ * either must call this.
+ *
+ * @fdt:	Device tree which was changed
+ */
+void fdt_cache_invalidate(const void *fdt);
+#else
+static inline int fdt_cache_phandle(const void *fdt, uint32_t phandle,
+				    int *offsetp)
+{
+	return 0;
+}
+
+static inline int fdt_cache_path(const void *fdt, const char *path,
+				 int namelen, int *offsetp)
+{
+	return 0;
+}
+
+static inline void fdt_cache_add_path(const void *fdt, const char *path,
+				      int namelen, int offset) {}
+
+static inline void fdt_cache_invalidate(const void *fdt) {}
+#endif
 #endif /* SWIG */
 
 extern struct fdt_header *working_fdt;  /* Pointer to the working fdt */
@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * LZ4 frame decompression
+ */
+
+#ifndef __LZ4_H
+#define __LZ4_H
+
+#include <linux/types.h>
+
+/**
+ * struct ulz4_stream - state of an LZ4 frame decompressed in pieces
+ *
+ * The members are private to lib/lz4_wrapper.c.
+ */
+struct ulz4_stream {
+	u8 *dst;
+	u8 *out;
+	u8 *end;
+	u8 *buf;
+	size_t buf_len;
+	size_t buf_size;
+	size_t block_max;
+	u32 block;
+	u32 skip;
+	int state;
+	int err;
+	bool independent_blocks;
+	bool has_block_checksum;
+	bool has_content_checksum;
+	bool whole;
+	u8 hdr_len;
+	u8 hdr[15];
+};
+
+/**
+ * ulz4fn() - Decompress an LZ4 frame
+ *
+ * This can decompress in place if the compressed data is loaded to the end
+ * of the output buffer.
+ *
+ * @src:	Compressed frame
+ * @srcn:	Size of the compressed frame in bytes
+ * @dst:	Output buffer
+ * @dstn:	On entry, size of the output buffer. On exit, the number of
+ *		bytes decompressed, even on error
+ * @return 0 if OK, -EINVAL if the frame is truncated or invalid,
+ * -EPROTONOSUPPORT if it is not an LZ4 frame, -ENOBUFS if the output buffer
+ * is too small, -EPROTO on corrupt data
+ */
+int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn);
+
+/**
+ * ulz4_stream_init() - Start decompressing an LZ4 frame in pieces
+ *
+ * The frame is passed to ulz4_stream_feed() in chunks of any size, for
+ * example as they are read from a device, and each block is decompressed
+ * as soon as it is complete. Blocks which are split between two chunks are
+ * collected in a buffer allocated with malloc(). This is the frame's maximum
+ * block size (up to 4MiB with 'lz4 -B7') or, if that cannot be allocated,
+ * the size of the block. If even that fails, ulz4_stream_feed() returns
+ * -ENOMEM and the caller can fall back to ulz4fn() on the whole frame,
+ * which needs no buffer.
+ *
+ * @s:		Stream state to set up
+ * @dst:	Output buffer
+ * @dstn:	Size of the output buffer in bytes
+ */
+void ulz4_stream_init(struct ulz4_stream *s, void *dst, size_t dstn);
+
+/**
+ * ulz4_stream_feed() - Decompress the next part of an LZ4 frame
+ *
+ * Input following the end of the frame is ignored.
+ *
+ * @s:		Stream state
+ * @src:	Next chunk of the frame
+ * @srcn:	Size of the chunk in bytes
+ * @return 0 if OK, else a negative error as for ulz4fn(), or -ENOMEM. Once
+ * an error is returned, later calls return it too.
+ */
+int ulz4_stream_feed(struct ulz4_stream *s, const void *src, size_t srcn);
+
+/**
+ * ulz4_stream_finish() - Finish decompressing an LZ4 frame
+ *
+ * This frees the stream's buffer and must be called even after an error.
+ *
+ * @s:		Stream state
+ * @dstn:	Returns the number of bytes decompressed
+ * @return 0 if the whole frame was decompressed, -EINVAL if it was
+ * incomplete, else the error returned by ulz4_stream_feed()
+ */
+int ulz4_stream_finish(struct ulz4_stream *s, size_t *dstn);
+
+#endif
@@ -186,6 +186,7 @@
 /* 55-57 reserved */
 
 #define SDHCI_ADMA_ADDRESS	0x58
+#define SDHCI_ADMA_ADDRESS_HI	0x5C
 
 /* 60-FB reserved */
 
@@ -235,6 +236,38 @@ struct sdhci_host;
  */
 #define SDHCI_DEFAULT_BOUNDARY_SIZE	(512 * 1024)
 #define SDHCI_DEFAULT_BOUNDARY_ARG	(7)
+
+/* Transfer modes, see sdhci_setup_cfg() */
+#define USE_SDMA	BIT(0)
+#define USE_ADMA	BIT(1)
+#define USE_ADMA64	BIT(2)
+
+/*
+ * ADMA2 descriptors. Each one moves at most ADMA_MAX_LEN bytes, which is
+ * kept a multiple of the block size so that every descriptor starts as
+ * aligned as the buffer itself. 32-bit descriptors are 8 bytes long and
+ * 64-bit ones 12 bytes, with the upper address bits following.
+ */
+#define ADMA_DESC_ATTR_VALID	BIT(0)
+#define ADMA_DESC_ATTR_END	BIT(1)
+#define ADMA_DESC_ATTR_INT	BIT(2)
+#define ADMA_DESC_TRANSFER_DATA	(2 << 4)
+
+#define ADMA_MAX_LEN		(65536 - MMC_MAX_BLOCK_LEN)
+#define ADMA32_DESC_LEN		8
+#define ADMA64_DESC_LEN		12
+#define ADMA_TABLE_NO_ENTRIES	\
+	DIV_ROUND_UP(CONFIG_SYS_MMC_MAX_BLK_COUNT * MMC_MAX_BLOCK_LEN, \
+		     ADMA_MAX_LEN)
+#define ADMA_TABLE_SZ		(ADMA_TABLE_NO_ENTRIES * ADMA64_DESC_LEN)
+
+struct sdhci_adma_desc {
+	u8 attr;
+	u8 reserved;
+	__le16 len;
+	__le32 addr_lo;
+	__le32 addr_hi;		/* 64-bit descriptors only */
+} __packed;
 struct sdhci_ops {
 #ifdef CONFIG_MMC_SDHCI_IO_ACCESSORS
 	u32	(*read_l)(struct sdhci_host *host, int reg);
@@ -272,6 +305,8 @@ struct sdhci_host {
 	uint	voltages;
 
 	struct mmc_config cfg;
+	uint	flags;			/* USE_SDMA, USE_ADMA, USE_ADMA64 */
+	void	*adma_desc_table;	/* ADMA2 descriptors */
 };
 
 #ifdef CONFIG_MMC_SDHCI_IO_ACCESSORS
@@ -52,6 +52,10 @@ struct hsearch_data {
 	struct _ENTRY *table;
 	unsigned int size;
 	unsigned int filled;
+	unsigned int deleted;
+	/* Entries sorted by key, if sorted_count is not 0; see hsort_r() */
+	ENTRY **sorted;
+	unsigned int sorted_count;
 /*
  * Callback function which will check whether the given change for variable
  * "__item" to "newval" may be applied or not, and possibly apply such change.
@@ -61,6 +65,11 @@ struct hsearch_data {
  */
 	int (*change_ok)(const ENTRY *__item, const char *newval, enum env_op,
 		int flag);
+/*
+ * Count of the changes made to the table, so that users can tell whether it
+ * still matches a copy which was exported earlier
+ */
+	unsigned int changes;
 };
 
 /* Create a new hash table which will contain at most "__nel" elements.  */
@@ -79,8 +88,10 @@ extern int hsearch_r(ENTRY __item, ACTION __action, ENTRY ** __retval,
 		     struct hsearch_data *__htab, int __flag);
 
 /*
- * Search for an entry matching "__match".  Otherwise, Same semantics
- * as hsearch_r().
+ * Search for the next entry, in key order, whose key starts with "__match".
+ * "__last_idx" is 0 to start, or the value returned by the previous call.
+ * Unlike hsearch_r(), the value returned is a position in the sorted list of
+ * entries, not an index into the table; it is 0 if nothing matches.
  */
 extern int hmatch_r(const char *__match, int __last_idx, ENTRY ** __retval,
 		    struct hsearch_data *__htab);
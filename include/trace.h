@@ -23,11 +23,14 @@ enum {
 	 * this value.
 	 */
 	FUNC_SITE_SIZE	= 4,	/* distance between function sites */
+
+	TRACE_STAGE_NAME_LEN	= 32,	/* space for a bootstage name */
 };
 
 enum trace_chunk_type {
 	TRACE_CHUNK_FUNCS,
 	TRACE_CHUNK_CALLS,
+	TRACE_CHUNK_STAGES,
 };
 
 /* A trace record for a function, as written to the profile output file */
@@ -42,6 +45,32 @@ struct trace_output_hdr {
 	uint32_t rec_count;		/* Number of records */
 };
 
+/* Flags for trace_output_stage */
+enum trace_stage_flags {
+	TRACE_STAGEF_ACCUM	= 1 << 0,	/* Accumulated time */
+	TRACE_STAGEF_INITCALL	= 1 << 1,	/* Init function, see 'func' */
+	TRACE_STAGEF_ERROR	= 1 << 2,	/* Error record */
+};
+
+/*
+ * A bootstage record, as written to the profile output file
+ *
+ * A mark has a start time and no duration. An accumulated record has the
+ * start time of its last use and the total time taken. An init function
+ * has the time it was called and the time it took.
+ *
+ * For an init function, 'func' is encoded as in struct trace_call: the
+ * offset of the function from the start of the code (&_init on sandbox),
+ * rounded down to a multiple of FUNC_SITE_SIZE. It is 0 for other records.
+ */
+struct trace_output_stage {
+	uint32_t start_us;		/* Start time in microseconds */
+	uint32_t time_us;		/* Time taken, 0 for a mark */
+	uint32_t flags;			/* enum trace_stage_flags */
+	uint32_t func;			/* Function offset into code */
+	char name[TRACE_STAGE_NAME_LEN];	/* Name, nul-terminated */
+};
+
 /* Print statistics about traced function calls */
 void trace_print_stats(void);
 
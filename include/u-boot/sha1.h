@@ -24,6 +24,8 @@ extern "C" {
 
 extern const uint8_t sha1_der_prefix[];
 
+struct sha_engine;
+
 /**
  * \brief	   SHA-1 context structure
  */
@@ -32,6 +34,7 @@ typedef struct
     unsigned long total[2];	/*!< number of bytes processed	*/
     unsigned long state[5];	/*!< intermediate digest state	*/
     unsigned char buffer[64];	/*!< data block being processed */
+    const struct sha_engine *engine; /*!< block engine, or NULL	*/
 }
 sha1_context;
 
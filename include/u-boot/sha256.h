@@ -9,10 +9,13 @@ extern const uint8_t sha256_der_prefix[];
 /* Reset watchdog each time we process this many bytes */
 #define CHUNKSZ_SHA256	(64 * 1024)
 
+struct sha_engine;
+
 typedef struct {
 	uint32_t total[2];
 	uint32_t state[8];
 	uint8_t buffer[64];
+	const struct sha_engine *engine;	/* block engine, or NULL */
 } sha256_context;
 
 void sha256_starts(sha256_context * ctx);
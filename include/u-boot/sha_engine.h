@@ -0,0 +1,54 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Pluggable SHA-1/SHA-256 block transforms
+ */
+
+#ifndef _SHA_ENGINE_H
+#define _SHA_ENGINE_H
+
+#include <linker_lists.h>
+
+/**
+ * struct sha_engine - an accelerated SHA block transform
+ *
+ * lib/sha1.c and lib/sha256.c hand whole 64-byte blocks to the first
+ * registered engine that implements the algorithm and whose probe()
+ * succeeds, falling back to the portable C code otherwise. The digest
+ * state is passed as host-order 32-bit words, as in FIPS 180-4.
+ *
+ * @name:		Engine name
+ * @probe:		Check whether the engine can be used on this CPU, or
+ *			NULL if it always can
+ * @sha1_blocks:	Process @blocks blocks of @data into @state, or NULL
+ * @sha256_blocks:	Process @blocks blocks of @data into @state, or NULL
+ */
+struct sha_engine {
+	const char *name;
+	bool (*probe)(void);
+	void (*sha1_blocks)(uint32_t state[5], const uint8_t *data,
+			    int blocks);
+	void (*sha256_blocks)(uint32_t state[8], const uint8_t *data,
+			      int blocks);
+};
+
+/* Declare a new SHA engine */
+#define U_BOOT_SHA_ENGINE(__name)					\
+	ll_entry_declare(struct sha_engine, __name, sha_engine)
+
+enum sha_engine_algo {
+	SHA_ENGINE_SHA1,
+	SHA_ENGINE_SHA256,
+};
+
+/**
+ * sha_engine_find() - Find the engine to use for an algorithm
+ *
+ * This probes the engines, so it is called once from sha1_starts() or
+ * sha256_starts() and the result is kept in the hash context.
+ *
+ * @algo:	Algorithm needed
+ * @return the engine, or NULL to use the C implementation
+ */
+const struct sha_engine *sha_engine_find(enum sha_engine_algo algo);
+
+#endif /* _SHA_ENGINE_H */
@@ -13,10 +13,71 @@
 #include <common.h>
 #include <compiler.h>
 
+/* Bit-reflected Castagnoli polynomial, as implemented by the CRC32C insns */
+#define CRC32C_POLY	0x82F63B78
+
+#if CONFIG_IS_ENABLED(CRC32_SLICE_BY_8) && __BYTE_ORDER == __LITTLE_ENDIAN
+#define CRC32C_SLICE_BY_8
+
+/*
+ * Extra tables for slice-by-8, built by crc32c_init() for the polynomial
+ * in crc32c_slice_poly: crc32c_slice[k][n] is the CRC of byte n followed
+ * by k + 1 zero bytes.
+ */
+static uint32_t crc32c_slice[7][256];
+static uint32_t crc32c_slice_poly;
+#endif
+
+#ifdef CONFIG_ARMV8_CRC32
+static uint32_t crc32c_armv8(uint32_t crc, const u8 *p, int length)
+{
+	for (; length > 0 && ((unsigned long)p & 7); length--)
+		asm(".arch_extension crc\n\tcrc32cb %w0, %w0, %w1"
+		    : "+r" (crc) : "r" (*p++));
+	for (; length >= 8; length -= 8, p += 8)
+		asm(".arch_extension crc\n\tcrc32cx %w0, %w0, %x1"
+		    : "+r" (crc) : "r" (*(const u64 *)p));
+	for (; length > 0; length--)
+		asm(".arch_extension crc\n\tcrc32cb %w0, %w0, %w1"
+		    : "+r" (crc) : "r" (*p++));
+
+	return crc;
+}
+#endif
+
 uint32_t crc32c_cal(uint32_t crc, const char *data, int length,
 		    uint32_t *crc32c_table)
 {
-	while (length--)
+	/* Entry 128 of a reflected table is the polynomial itself */
+#ifdef CONFIG_ARMV8_CRC32
+	if (crc32c_table[128] == CRC32C_POLY)
+		return crc32c_armv8(crc, (const u8 *)data, length);
+#endif
+#ifdef CRC32C_SLICE_BY_8
+	if (crc32c_table[128] == crc32c_slice_poly) {
+		const uint32_t *p;
+
+		for (; length > 0 && ((unsigned long)data & 3); length--)
+			crc = crc32c_table[(u8)(crc ^ *data++)] ^ (crc >> 8);
+
+		for (p = (const uint32_t *)data; length >= 8; length -= 8) {
+			uint32_t lo = *p++ ^ crc;
+			uint32_t hi = *p++;
+
+			crc = crc32c_slice[6][lo & 255] ^
+			      crc32c_slice[5][(lo >> 8) & 255] ^
+			      crc32c_slice[4][(lo >> 16) & 255] ^
+			      crc32c_slice[3][lo >> 24] ^
+			      crc32c_slice[2][hi & 255] ^
+			      crc32c_slice[1][(hi >> 8) & 255] ^
+			      crc32c_slice[0][(hi >> 16) & 255] ^
+			      crc32c_table[hi >> 24];
+		}
+		data = (const char *)p;
+	}
+#endif
+
+	while (length-- > 0)
 		crc = crc32c_table[(u8)(crc ^ *data++)] ^ (crc >> 8);
 
 	return crc;
@@ -35,4 +96,15 @@ void crc32c_init(uint32_t *crc32c_table, uint32_t pol)
 
 		crc32c_table[i] = v;
 	}
+
+#ifdef CRC32C_SLICE_BY_8
+	for (i = 0; i < 256; i++) {
+		v = crc32c_table[i];
+		for (j = 0; j < 7; j++) {
+			v = crc32c_table[v & 255] ^ (v >> 8);
+			crc32c_slice[j][i] = v;
+		}
+	}
+	crc32c_slice_poly = poly;
+#endif
 }
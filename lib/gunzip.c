@@ -80,6 +80,25 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 }
 
 #ifdef CONFIG_CMD_UNZIP
+/*
+ * Output is inflated this much at a time, so that the CRC is calculated
+ * while the data is still in the cache rather than in a separate pass over
+ * the whole write buffer.
+ */
+#define GZWRITE_INFLATE_SIZE	(64 << 10)
+
+/* Timing of the current gzwrite(), in ms */
+static ulong gzwrite_start;
+static ulong gzwrite_write_time;
+
+/* Throughput in kB/s (which is bytes per ms) since gzwrite() started */
+static u64 gzwrite_rate(u64 bytes)
+{
+	ulong time = get_timer(gzwrite_start);
+
+	return time ? lldiv(bytes, time) : 0;
+}
+
 __weak
 void gzwrite_progress_init(u64 expectedsize)
 {
@@ -92,7 +111,8 @@ void gzwrite_progress(int iteration,
 		     u64 total_bytes)
 {
 	if (0 == (iteration & 3))
-		printf("%llu/%llu\r", bytes_written, total_bytes);
+		printf("%llu/%llu, %llu kB/s\r", bytes_written, total_bytes,
+		       gzwrite_rate(bytes_written));
 }
 
 __weak
@@ -105,6 +125,9 @@ void gzwrite_progress_finish(int returnval,
 	if (0 == returnval) {
 		printf("\n\t%llu bytes, crc 0x%08x\n",
 		       total_bytes, calculated_crc);
+		printf("\t%lu ms, %llu kB/s, %lu ms writing\n",
+		       get_timer(gzwrite_start), gzwrite_rate(total_bytes),
+		       gzwrite_write_time);
 	} else {
 		printf("\n\tuncompressed %llu of %llu\n"
 		       "\tcrcs == 0x%08x/0x%08x\n",
@@ -190,6 +213,8 @@ int gzwrite(unsigned char *src, int len,
 	}
 
 	gzwrite_progress_init(szexpected);
+	gzwrite_start = get_timer(0);
+	gzwrite_write_time = 0;
 
 	s.zalloc = gzalloc;
 	s.zfree = gzfree;
@@ -215,19 +240,29 @@ int gzwrite(unsigned char *src, int len,
 		/* run inflate() on input until output buffer not full */
 		do {
 			unsigned long blocks_written;
-			int numfilled;
+			int numfilled = 0;
 			lbaint_t writeblocks;
-
-			s.avail_out = szwritebuf;
-			s.next_out = writebuf;
-			r = inflate(&s, Z_SYNC_FLUSH);
-			if ((r != Z_OK) &&
-			    (r != Z_STREAM_END)) {
-				printf("Error: inflate() returned %d\n", r);
-				goto out;
-			}
-			numfilled = szwritebuf - s.avail_out;
-			crc = crc32(crc, writebuf, numfilled);
+			ulong start;
+			uInt step;
+
+			/* fill the buffer, hashing each piece as it is made */
+			do {
+				step = min_t(ulong, szwritebuf - numfilled,
+					     GZWRITE_INFLATE_SIZE);
+				s.avail_out = step;
+				s.next_out = writebuf + numfilled;
+				r = inflate(&s, Z_SYNC_FLUSH);
+				if ((r != Z_OK) &&
+				    (r != Z_STREAM_END)) {
+					printf("Error: inflate() returned %d\n",
+					       r);
+					goto out;
+				}
+				step -= s.avail_out;
+				crc = crc32(crc, writebuf + numfilled, step);
+				numfilled += step;
+			} while (r != Z_STREAM_END && s.avail_out == 0 &&
+				 numfilled < szwritebuf);
 			totalfilled += numfilled;
 			if (numfilled < szwritebuf) {
 				writeblocks = (numfilled+dev->blksz-1)
@@ -241,8 +276,10 @@ int gzwrite(unsigned char *src, int len,
 			gzwrite_progress(iteration++,
 					 totalfilled,
 					 szexpected);
+			start = get_timer(0);
 			blocks_written = blk_dwrite(dev, outblock,
 						    writeblocks, writebuf);
+			gzwrite_write_time += get_timer(start);
 			outblock += blocks_written;
 			if (ctrlc()) {
 				puts("abort\n");
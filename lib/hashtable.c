@@ -115,6 +115,8 @@ int hcreate_r(size_t nel, struct hsearch_data *htab)
 
 	htab->size = nel;
 	htab->filled = 0;
+	htab->deleted = 0;
+	htab->sorted_count = 0;
 
 	/* allocate memory and zero out */
 	htab->table = (_ENTRY *) calloc(htab->size + 1, sizeof(_ENTRY));
@@ -145,9 +147,9 @@ void hdestroy_r(struct hsearch_data *htab)
 		return;
 	}
 
-	/* free used memory */
+	/* free used memory; deleted entries still have their key */
 	for (i = 1; i <= htab->size; ++i) {
-		if (htab->table[i].used > 0) {
+		if (htab->table[i].used) {
 			ENTRY *ep = &htab->table[i].entry;
 
 			free((void *)ep->key);
@@ -155,9 +157,120 @@ void hdestroy_r(struct hsearch_data *htab)
 		}
 	}
 	free(htab->table);
+	free(htab->sorted);
 
 	/* the sign for an existing table is an value != NULL in htable */
 	htab->table = NULL;
+	htab->sorted = NULL;
+	htab->sorted_count = 0;
+	htab->changes++;
+}
+
+/*
+ * Hash function for keys (FNV-1a). All of the key is used, as environments
+ * often have many variables with a long common prefix.
+ */
+static unsigned int hash_key(const char *key)
+{
+	unsigned int hval = 2166136261u;
+
+	while (*key)
+		hval = (hval ^ (unsigned char)*key++) * 16777619;
+
+	return hval;
+}
+
+/*
+ * Move the entries to a new table with room for at least @nel entries,
+ * dropping deleted ones. Any pointers to entries are no longer valid.
+ *
+ * Returns 1 on success, 0 if there is not enough memory.
+ */
+static int hresize_r(struct hsearch_data *htab, size_t nel)
+{
+	struct hsearch_data new = { .table = NULL };
+	unsigned int i, idx, hval, hval2;
+	_ENTRY *ent;
+
+	if (!hcreate_r(nel, &new))
+		return 0;
+
+	debug("hresize: %d entries, size %d -> %d\n", htab->filled,
+	      htab->size, new.size);
+	for (i = 1; i <= htab->size; ++i) {
+		ent = &htab->table[i];
+		if (ent->used < 0)
+			free((void *)ent->entry.key);
+		if (ent->used <= 0)
+			continue;
+
+		/* Same probe sequence as hsearch_r(); keys are unique */
+		hval = hash_key(ent->entry.key) % new.size;
+		if (hval == 0)
+			++hval;
+		hval2 = 1 + hval % (new.size - 2);
+		for (idx = hval; new.table[idx].used; ) {
+			if (idx <= hval2)
+				idx = new.size + idx - hval2;
+			else
+				idx -= hval2;
+		}
+		new.table[idx].used = hval;
+		new.table[idx].entry = ent->entry;
+	}
+	free(htab->table);
+
+	htab->table = new.table;
+	htab->size = new.size;
+	htab->deleted = 0;
+	htab->sorted_count = 0;
+
+	return 1;
+}
+
+static int cmpkey(const void *p1, const void *p2)
+{
+	ENTRY *e1 = *(ENTRY **) p1;
+	ENTRY *e2 = *(ENTRY **) p2;
+
+	return (strcmp(e1->key, e2->key));
+}
+
+/*
+ * Make sure that htab->sorted lists the entries sorted by key. The list is
+ * kept until an entry is added or the table is resized. Deleting an entry
+ * leaves it in the list, so the code using it must skip unused entries;
+ * their key is kept until the slot is used again for that reason.
+ *
+ * Returns 0 on success, -ENOMEM if there is not enough memory.
+ */
+static int hsort_r(struct hsearch_data *htab)
+{
+	unsigned int i, n;
+
+	if (htab->sorted_count || !htab->filled)
+		return 0;
+
+	free(htab->sorted);
+	htab->sorted = malloc(htab->filled * sizeof(*htab->sorted));
+	if (!htab->sorted)
+		return -ENOMEM;
+
+	for (i = 1, n = 0; i <= htab->size; ++i) {
+		if (htab->table[i].used > 0)
+			htab->sorted[n++] = &htab->table[i].entry;
+	}
+	qsort(htab->sorted, n, sizeof(*htab->sorted), cmpkey);
+	htab->sorted_count = n;
+
+	return 0;
+}
+
+/* Check if an entry in htab->sorted is in use */
+static inline int hsorted_used(struct hsearch_data *htab, unsigned int i)
+{
+	return ((_ENTRY *)((char *)htab->sorted[i] -
+			   offsetof(_ENTRY, entry)))->used > 0;
 }
 
 /*
@@ -167,9 +280,8 @@ void hdestroy_r(struct hsearch_data *htab)
 /*
  * This is the search function. It uses double hashing with open addressing.
  * The argument item.key has to be a pointer to an zero terminated, most
- * probably strings of chars. The function for generating a number of the
- * strings is simple but fast. It can be replaced by a more complex function
- * like ajw (see [Aho,Sethi,Ullman]) if the needs are shown.
+ * probably strings of chars. The number for the string is generated by
+ * hash_key().
  *
  * We use an trick to speed up the lookup. The table is created by hcreate
  * with one more element available. This enables us to use the index zero
@@ -195,23 +307,47 @@ void hdestroy_r(struct hsearch_data *htab)
  *   internal hash table, which is also guaranteed to be positive.
  *   This allows us direct access to the found hash table slot for
  *   example for functions like hdelete().
+ * - The table grows when entries are added to it, so a pointer to an
+ *   entry is only valid until the next entry is added. Callbacks which
+ *   are called when an entry is changed must not add entries.
  */
 
+/*
+ * Keys are matched in sorted order. The value returned is the position after
+ * the match in the sorted list, to pass as @last_idx for the next match.
+ */
 int hmatch_r(const char *match, int last_idx, ENTRY ** retval,
 	     struct hsearch_data *htab)
 {
-	unsigned int idx;
+	unsigned int idx, lo, hi, mid;
 	size_t key_len = strlen(match);
 
-	for (idx = last_idx + 1; idx < htab->size; ++idx) {
-		if (htab->table[idx].used <= 0)
-			continue;
-		if (!strncmp(match, htab->table[idx].entry.key, key_len)) {
-			*retval = &htab->table[idx].entry;
-			return idx;
+	if (hsort_r(htab))
+		goto not_found;
+
+	idx = last_idx;
+	if (!idx) {
+		/* Find the first key which is not before the prefix */
+		for (lo = 0, hi = htab->sorted_count; lo < hi; ) {
+			mid = (lo + hi) / 2;
+			if (strcmp(htab->sorted[mid]->key, match) < 0)
+				lo = mid + 1;
+			else
+				hi = mid;
 		}
+		idx = lo;
 	}
 
+	for (; idx < htab->sorted_count; ++idx) {
+		if (strncmp(match, htab->sorted[idx]->key, key_len))
+			break;
+		if (hsorted_used(htab, idx)) {
+			*retval = htab->sorted[idx];
+			return idx + 1;
+		}
+	}
+
+not_found:
 	__set_errno(ESRCH);
 	*retval = NULL;
 	return 0;
@@ -251,6 +387,8 @@ static inline int _compare_and_overwrite_entry(ENTRY item, ACTION action,
 				return 0;
 			}
 
+			if (strcmp(htab->table[idx].entry.data, item.data))
+				htab->changes++;
 			free(htab->table[idx].entry.data);
 			htab->table[idx].entry.data = strdup(item.data);
 			if (!htab->table[idx].entry.data) {
@@ -271,25 +409,15 @@ int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
 	      struct hsearch_data *htab, int flag)
 {
 	unsigned int hval;
-	unsigned int count;
-	unsigned int len = strlen(item.key);
 	unsigned int idx;
 	unsigned int first_deleted = 0;
 	int ret;
 
-	/* Compute an value for the given string. Perhaps use a better method. */
-	hval = len;
-	count = len;
-	while (count-- > 0) {
-		hval <<= 4;
-		hval += item.key[count];
-	}
-
 	/*
 	 * First hash function:
 	 * simply take the modul but prevent zero.
 	 */
-	hval %= htab->size;
+	hval = hash_key(item.key) % htab->size;
 	if (hval == 0)
 		++hval;
 
@@ -335,6 +463,10 @@ int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
 			if (idx == hval)
 				break;
 
+			if (htab->table[idx].used == -1
+			    && !first_deleted)
+				first_deleted = idx;
+
 			/* If entry is found use it. */
 			ret = _compare_and_overwrite_entry(item, action, retval,
 				htab, flag, hval, idx);
@@ -346,6 +478,15 @@ int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
 
 	/* An empty bucket has been found. */
 	if (action == ENTER) {
+		/*
+		 * Grow the table when it is 3/4 full, counting deleted
+		 * entries which make searches longer. If there are many of
+		 * those, this drops them and keeps the size.
+		 */
+		if ((htab->filled + htab->deleted + 1) * 4 > htab->size * 3 &&
+		    hresize_r(htab, max(htab->size, (htab->filled + 1) * 2)))
+			return hsearch_r(item, action, retval, htab, flag);
+
 		/*
 		 * If table is full and another entry should be
 		 * entered return with error.
@@ -360,9 +501,14 @@ int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
 		 * Create new entry;
 		 * create copies of item.key and item.data
 		 */
-		if (first_deleted)
+		if (first_deleted) {
 			idx = first_deleted;
+			free((void *)htab->table[idx].entry.key);
+			--htab->deleted;
+		}
 
+		/* The sorted list must be made again to include this */
+		htab->sorted_count = 0;
 		htab->table[idx].used = hval;
 		htab->table[idx].entry.key = strdup(item.key);
 		htab->table[idx].entry.data = strdup(item.data);
@@ -374,6 +520,7 @@ int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
 		}
 
 		++htab->filled;
+		htab->changes++;
 
 		/* This is a new entry, so look up a possible callback */
 		env_callback_init(&htab->table[idx].entry);
@@ -427,15 +574,20 @@ int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
 static void _hdelete(const char *key, struct hsearch_data *htab, ENTRY *ep,
 	int idx)
 {
-	/* free used ENTRY */
+	/*
+	 * free used ENTRY; the key is kept until the slot is used again, as
+	 * htab->sorted may still refer to it
+	 */
 	debug("hdelete: DELETING key \"%s\"\n", key);
-	free((void *)ep->key);
 	free(ep->data);
+	ep->data = NULL;
 	ep->callback = NULL;
 	ep->flags = 0;
 	htab->table[idx].used = -1;
 
 	--htab->filled;
+	++htab->deleted;
+	htab->changes++;
 }
 
 int hdelete_r(const char *key, struct hsearch_data *htab, int flag)
@@ -519,14 +671,6 @@ int hdelete_r(const char *key, struct hsearch_data *htab, int flag)
  *		bytes in the string will be '\0'-padded.
  */
 
-static int cmpkey(const void *p1, const void *p2)
-{
-	ENTRY *e1 = *(ENTRY **) p1;
-	ENTRY *e2 = *(ENTRY **) p2;
-
-	return (strcmp(e1->key, e2->key));
-}
-
 static int match_string(int flag, const char *str, const char *pat, void *priv)
 {
 	switch (flag & H_MATCH_METHOD) {
@@ -590,7 +734,7 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 		 char **resp, size_t size,
 		 int argc, char * const argv[])
 {
-	ENTRY *list[htab->size];
+	ENTRY **list;
 	char *res, *p;
 	size_t totlen;
 	int i, n;
@@ -603,15 +747,23 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 
 	debug("EXPORT  table = %p, htab.size = %d, htab.filled = %d, size = %lu\n",
 	      htab, htab->size, htab->filled, (ulong)size);
+
+	list = malloc((htab->filled + 1) * sizeof(*list));
+	if (!list || hsort_r(htab)) {
+		free(list);
+		__set_errno(ENOMEM);
+		return (-1);
+	}
+
 	/*
 	 * Pass 1:
-	 * search used entries,
+	 * search used entries in key order,
 	 * save addresses and compute total length
 	 */
-	for (i = 1, n = 0, totlen = 0; i <= htab->size; ++i) {
+	for (i = 0, n = 0, totlen = 0; i < htab->sorted_count; ++i) {
 
-		if (htab->table[i].used > 0) {
-			ENTRY *ep = &htab->table[i].entry;
+		if (hsorted_used(htab, i)) {
+			ENTRY *ep = htab->sorted[i];
 			int found = match_entry(ep, flag, argc, argv);
 
 			if ((argc > 0) && (found == 0))
@@ -642,27 +794,25 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 	}
 
 #ifdef DEBUG
-	/* Pass 1a: print unsorted list */
-	printf("Unsorted: n=%d\n", n);
+	/* Pass 1a: print list */
+	printf("Sorted: n=%d\n", n);
 	for (i = 0; i < n; ++i) {
 		printf("\t%3d: %p ==> %-10s => %s\n",
 		       i, list[i], list[i]->key, list[i]->data);
 	}
 #endif
 
-	/* Sort list by keys */
-	qsort(list, n, sizeof(ENTRY *), cmpkey);
-
 	/* Check if the user supplied buffer size is sufficient */
 	if (size) {
 		if (size < totlen + 1) {	/* provided buffer too small */
 			printf("Env export buffer too small: %lu, but need %lu\n",
 			       (ulong)size, (ulong)totlen + 1);
+			free(list);
 			__set_errno(ENOMEM);
 			return (-1);
 		}
 	} else {
-		size = totlen;
+		size = totlen + 1;
 	}
 
 	/* Check if the user provided a buffer */
@@ -674,6 +824,7 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 		/* no, allocate and clear one */
 		*resp = res = calloc(1, size);
 		if (res == NULL) {
+			free(list);
 			__set_errno(ENOMEM);
 			return (-1);
 		}
@@ -700,6 +851,7 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 		*p++ = sep;
 	}
 	*p = '\0';		/* terminate result */
+	free(list);
 
 	return size;
 }
@@ -827,7 +979,8 @@ int himport_r(struct hsearch_data *htab,
 	 * environment size), so we clip it to a reasonable value.
 	 * On the other hand we need to add some more entries for free
 	 * space when importing very small buffers. Both boundaries can
-	 * be overwritten in the board config file if needed.
+	 * be overwritten in the board config file if needed. The table
+	 * grows if more entries are added than it has room for.
 	 */
 
 	if (!htab->table) {
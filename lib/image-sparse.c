@@ -46,24 +46,101 @@
 
 static void default_log(const char *ignored, char *response) {}
 
+/*
+ * Find the whole erase groups within @blkcnt blocks from @blk, clipped to the
+ * end of the storage. Returns the number of blocks in them, or 0 if there are
+ * none or the storage cannot erase, with the first one in @startp.
+ */
+static lbaint_t sparse_erase_range(struct sparse_storage *info, lbaint_t blk,
+				   lbaint_t blkcnt, lbaint_t *startp)
+{
+	lbaint_t start, end;
+	u32 rem;
+
+	if (!info->erase || !info->erase_blks)
+		return 0;
+
+	start = blk + info->erase_blks - 1;
+	div_u64_rem(start, info->erase_blks, &rem);
+	start -= rem;
+
+	end = min(blk + blkcnt, info->start + info->size);
+	div_u64_rem(end, info->erase_blks, &rem);
+	end -= rem;
+
+	if (end <= start)
+		return 0;
+
+	*startp = start;
+	return end - start;
+}
+
+static int sparse_erase(struct sparse_storage *info, lbaint_t blk,
+			lbaint_t blkcnt)
+{
+	lbaint_t blks;
+
+	blks = info->erase(info, blk, blkcnt);
+	if (blks != blkcnt) {
+		printf("%s: %s" LBAFU " [" LBAFU "]\n",
+		       __func__, "Erase failed, block #", blk, blks);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Write @blkcnt blocks from @blkp out of a fill buffer of @fill_buf_num_blks */
+static int sparse_write_fill(struct sparse_storage *info, lbaint_t *blkp,
+			     lbaint_t blkcnt, const uint32_t *fill_buf,
+			     lbaint_t fill_buf_num_blks)
+{
+	lbaint_t blk = *blkp;
+	lbaint_t blks;
+	lbaint_t i;
+	lbaint_t j;
+
+	for (i = 0; i < blkcnt;) {
+		j = blkcnt - i;
+		if (j > fill_buf_num_blks)
+			j = fill_buf_num_blks;
+		blks = info->write(info, blk, j, fill_buf);
+		/* blks might be > j (eg. NAND bad-blocks) */
+		if (blks < j) {
+			printf("%s: %s " LBAFU " [" LBAFU "]\n", __func__,
+			       "Write failed, block #", blk, j);
+			return -1;
+		}
+		blk += blks;
+		i += j;
+	}
+
+	*blkp = blk;
+	return 0;
+}
+
 int write_sparse_image(struct sparse_storage *info,
 		       const char *part_name, void *data, char *response)
 {
 	lbaint_t blk;
 	lbaint_t blkcnt;
 	lbaint_t blks;
+	lbaint_t erase_start;
+	lbaint_t erase_cnt;
 	uint32_t bytes_written = 0;
 	unsigned int chunk;
 	unsigned int offset;
 	unsigned int chunk_data_sz;
 	uint32_t *fill_buf = NULL;
+	uint32_t fill_buf_val = 0;
+	lbaint_t fill_buf_len = 0;
 	uint32_t fill_val;
 	sparse_header_t *sparse_header;
 	chunk_header_t *chunk_header;
 	uint32_t total_blocks = 0;
-	int fill_buf_num_blks;
-	int i;
-	int j;
+	lbaint_t fill_buf_num_blks;
+	lbaint_t len;
+	lbaint_t i;
 
 	fill_buf_num_blks = CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz;
 
@@ -137,7 +214,7 @@ int write_sparse_image(struct sparse_storage *info,
 			    (sparse_header->chunk_hdr_sz + chunk_data_sz)) {
 				info->mssg("Bogus chunk size for chunk type Raw",
 					   response);
-				return -1;
+				goto err;
 			}
 
 			if (blk + blkcnt > info->start + info->size) {
@@ -146,7 +223,7 @@ int write_sparse_image(struct sparse_storage *info,
 				    __func__);
 				info->mssg("Request would exceed partition size!",
 					   response);
-				return -1;
+				goto err;
 			}
 
 			blks = info->write(info, blk, blkcnt, data);
@@ -156,7 +233,7 @@ int write_sparse_image(struct sparse_storage *info,
 				       __func__, "Write failed, block #",
 				       blk, blks);
 				info->mssg("flash write failure", response);
-				return -1;
+				goto err;
 			}
 			blk += blks;
 			bytes_written += blkcnt * info->blksz;
@@ -168,28 +245,39 @@ int write_sparse_image(struct sparse_storage *info,
 			if (chunk_header->total_sz !=
 			    (sparse_header->chunk_hdr_sz + sizeof(uint32_t))) {
 				info->mssg("Bogus chunk size for chunk type FILL", response);
-				return -1;
+				goto err;
 			}
 
-			fill_buf = (uint32_t *)
-				   memalign(ARCH_DMA_MINALIGN,
-					    ROUNDUP(
-						info->blksz * fill_buf_num_blks,
-						ARCH_DMA_MINALIGN));
 			if (!fill_buf) {
-				info->mssg("Malloc failed for: CHUNK_TYPE_FILL",
-					   response);
-				return -1;
+				fill_buf = (uint32_t *)
+					   memalign(ARCH_DMA_MINALIGN,
+						    ROUNDUP(
+							info->blksz * fill_buf_num_blks,
+							ARCH_DMA_MINALIGN));
+				if (!fill_buf) {
+					info->mssg("Malloc failed for: CHUNK_TYPE_FILL",
+						   response);
+					goto err;
+				}
 			}
 
 			fill_val = *(uint32_t *)data;
 			data = (char *)data + sizeof(uint32_t);
 
-			for (i = 0;
-			     i < (info->blksz * fill_buf_num_blks /
-				  sizeof(fill_val));
-			     i++)
+			/*
+			 * The buffer is kept across chunks, so only fill as
+			 * much of it as this chunk needs and has not already
+			 * been filled with the same value.
+			 */
+			if (fill_val != fill_buf_val)
+				fill_buf_len = 0;
+			len = min(blkcnt, fill_buf_num_blks) * info->blksz /
+			      sizeof(fill_val);
+			for (i = fill_buf_len; i < len; i++)
 				fill_buf[i] = fill_val;
+			if (len > fill_buf_len)
+				fill_buf_len = len;
+			fill_buf_val = fill_val;
 
 			if (blk + blkcnt > info->start + info->size) {
 				printf(
@@ -197,34 +285,44 @@ int write_sparse_image(struct sparse_storage *info,
 				    __func__);
 				info->mssg("Request would exceed partition size!",
 					   response);
-				return -1;
+				goto err;
 			}
 
-			for (i = 0; i < blkcnt;) {
-				j = blkcnt - i;
-				if (j > fill_buf_num_blks)
-					j = fill_buf_num_blks;
-				blks = info->write(info, blk, j, fill_buf);
-				/* blks might be > j (eg. NAND bad-blocks) */
-				if (blks < j) {
-					printf("%s: %s " LBAFU " [%d]\n",
-					       __func__,
-					       "Write failed, block #",
-					       blk, j);
-					info->mssg("flash write failure",
-						   response);
-					free(fill_buf);
-					return -1;
-				}
-				blk += blks;
-				i += j;
+			/*
+			 * Zero fills are erased where they cover whole erase
+			 * groups; only the unaligned head and tail are written.
+			 */
+			erase_cnt = 0;
+			if (!fill_val)
+				erase_cnt = sparse_erase_range(info, blk, blkcnt,
+							       &erase_start);
+			if (erase_cnt) {
+				len = blk + blkcnt - erase_start - erase_cnt;
+				if (sparse_write_fill(info, &blk,
+						      erase_start - blk,
+						      fill_buf,
+						      fill_buf_num_blks) ||
+				    sparse_erase(info, erase_start, erase_cnt))
+					goto err_write;
+				blk += erase_cnt;
+				if (sparse_write_fill(info, &blk, len, fill_buf,
+						      fill_buf_num_blks))
+					goto err_write;
+			} else if (sparse_write_fill(info, &blk, blkcnt,
+						     fill_buf,
+						     fill_buf_num_blks)) {
+				goto err_write;
 			}
 			bytes_written += blkcnt * info->blksz;
 			total_blocks += chunk_data_sz / sparse_header->blk_sz;
-			free(fill_buf);
 			break;
 
 		case CHUNK_TYPE_DONT_CARE:
+			/*
+			 * This must not be erased: when the host splits an
+			 * image, each piece marks the blocks written by the
+			 * other pieces as don't-care.
+			 */
 			blk += info->reserve(info, blk, blkcnt);
 			total_blocks += chunk_header->chunk_sz;
 			break;
@@ -234,7 +332,7 @@ int write_sparse_image(struct sparse_storage *info,
 			    sparse_header->chunk_hdr_sz) {
 				info->mssg("Bogus chunk size for chunk type Dont Care",
 					   response);
-				return -1;
+				goto err;
 			}
 			total_blocks += chunk_header->chunk_sz;
 			data += chunk_data_sz;
@@ -244,10 +342,12 @@ int write_sparse_image(struct sparse_storage *info,
 			printf("%s: Unknown chunk type: %x\n", __func__,
 			       chunk_header->chunk_type);
 			info->mssg("Unknown chunk type", response);
-			return -1;
+			goto err;
 		}
 	}
 
+	free(fill_buf);
+
 	debug("Wrote %d blocks, expected to write %d blocks\n",
 	      total_blocks, sparse_header->total_blks);
 	printf("........ wrote %u bytes to '%s'\n", bytes_written, part_name);
@@ -258,4 +358,10 @@ int write_sparse_image(struct sparse_storage *info,
 	}
 
 	return 0;
+
+err_write:
+	info->mssg("flash write failure", response);
+err:
+	free(fill_buf);
+	return -1;
 }
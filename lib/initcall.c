@@ -9,25 +9,46 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Init functions are only timed once bootstage is ready to record them */
+static bool initcall_timed(void)
+{
+#if CONFIG_IS_ENABLED(BOOTSTAGE_INITCALLS)
+	return gd->bootstage != NULL;
+#else
+	return false;
+#endif
+}
+
 int initcall_run_list(const init_fnc_t init_sequence[])
 {
 	const init_fnc_t *init_fnc_ptr;
 
 	for (init_fnc_ptr = init_sequence; *init_fnc_ptr; ++init_fnc_ptr) {
 		unsigned long reloc_ofs = 0;
+		uint32_t start = 0;
+		bool timed;
 		int ret;
 
 		if (gd->flags & GD_FLG_RELOC)
 			reloc_ofs = gd->reloc_off;
 #ifdef CONFIG_EFI_APP
 		reloc_ofs = (unsigned long)image_base;
+#elif defined(CONFIG_SANDBOX)
+		/* Sandbox code runs where it was loaded and is not moved */
+		reloc_ofs = 0;
 #endif
 		debug("initcall: %p", (char *)*init_fnc_ptr - reloc_ofs);
 		if (gd->flags & GD_FLG_RELOC)
 			debug(" (relocated to %p)\n", (char *)*init_fnc_ptr);
 		else
 			debug("\n");
+		timed = initcall_timed();
+		if (timed)
+			start = timer_get_boot_us();
 		ret = (*init_fnc_ptr)();
+		if (timed)
+			bootstage_initcall((ulong)*init_fnc_ptr - reloc_ofs,
+					   start, timer_get_boot_us() - start);
 		if (ret) {
 			printf("initcall sequence %p failed at call %p (err=%d)\n",
 			       init_sequence,
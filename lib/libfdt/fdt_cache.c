@@ -0,0 +1,356 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Cache of phandle and path lookups in a flat device tree
+ *
+ * fdt_node_offset_by_phandle() and fdt_path_offset() walk the tree from
+ * the start on every call. This keeps an index of the phandles and the
+ * result of the last few path lookups for each of the device trees last
+ * used, e.g. U-Boot's own and the one being prepared for the OS.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <linux/libfdt.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define FDT_CACHE_BLOBS		4
+#define FDT_CACHE_PATHS		8
+#define FDT_CACHE_PATH_LEN	40
+
+struct fdt_cache_phandle {
+	uint32_t phandle;
+	int offset;
+};
+
+struct fdt_cache_path {
+	int namelen;			/* 0 if this entry is not used */
+	int offset;
+	char path[FDT_CACHE_PATH_LEN];
+};
+
+struct fdt_cache {
+	ulong last_use;			/* value of fdt_caches.uses when last used */
+	const void *fdt;
+	uint32_t totalsize;
+	uint32_t size_dt_struct;
+	uint32_t size_dt_strings;
+	uint bits;			/* log2 of the index size, 0 if none */
+	uint size;			/* number of entries allocated */
+	struct fdt_cache_phandle *phandles;
+	uint next_path;
+	struct fdt_cache_path paths[FDT_CACHE_PATHS];
+};
+
+/* The caches for the device trees used most recently, allocated as needed */
+struct fdt_caches {
+	ulong malloc_flags;		/* gd->flags which tell the heap used */
+	ulong uses;
+	struct fdt_cache *cache[FDT_CACHE_BLOBS];
+};
+
+static ulong fdt_cache_malloc_flags(void)
+{
+	return gd->flags & (GD_FLG_RELOC | GD_FLG_FULL_MALLOC_INIT);
+}
+
+/* Get a cache for @fdt, reusing the one used longest ago if needed */
+static struct fdt_cache *fdt_cache_find_blob(const void *fdt)
+{
+	struct fdt_caches *caches = gd->fdt_cache;
+	struct fdt_cache *cache, *oldest = NULL;
+	int i;
+
+	/*
+	 * Memory from the early heap is not there after relocation, and
+	 * cannot be freed when the full heap is set up
+	 */
+	if (caches && caches->malloc_flags != fdt_cache_malloc_flags())
+		caches = NULL;
+	if (!caches) {
+		caches = calloc(1, sizeof(*caches));
+		if (!caches)
+			return NULL;
+		caches->malloc_flags = fdt_cache_malloc_flags();
+		gd->fdt_cache = caches;
+	}
+
+	for (i = 0; i < FDT_CACHE_BLOBS; i++) {
+		cache = caches->cache[i];
+		if (!cache) {
+			cache = calloc(1, sizeof(*cache));
+			if (!cache)
+				break;
+			caches->cache[i] = cache;
+			oldest = cache;
+			break;
+		}
+		if (cache->fdt == fdt) {
+			oldest = cache;
+			break;
+		}
+		if (!oldest || cache->last_use < oldest->last_use)
+			oldest = cache;
+	}
+	if (oldest)
+		oldest->last_use = ++caches->uses;
+
+	return oldest;
+}
+
+/* Get the cache for @fdt, dropping what is cached if the tree changed */
+static struct fdt_cache *fdt_cache_get(const void *fdt)
+{
+	struct fdt_cache *cache;
+	int i;
+
+	cache = fdt_cache_find_blob(fdt);
+	if (!cache)
+		return NULL;
+
+	if (cache->fdt != fdt || cache->totalsize != fdt_totalsize(fdt) ||
+	    cache->size_dt_struct != fdt_size_dt_struct(fdt) ||
+	    cache->size_dt_strings != fdt_size_dt_strings(fdt)) {
+		cache->fdt = fdt;
+		cache->totalsize = fdt_totalsize(fdt);
+		cache->size_dt_struct = fdt_size_dt_struct(fdt);
+		cache->size_dt_strings = fdt_size_dt_strings(fdt);
+		cache->bits = 0;
+		for (i = 0; i < FDT_CACHE_PATHS; i++)
+			cache->paths[i].namelen = 0;
+	}
+
+	return cache;
+}
+
+static uint fdt_cache_hash(struct fdt_cache *cache, uint32_t phandle)
+{
+	return (phandle * 0x9e3779b1) >> (32 - cache->bits);
+}
+
+static int fdt_cache_find(struct fdt_cache *cache, uint32_t phandle)
+{
+	struct fdt_cache_phandle *ent;
+	uint mask = (1 << cache->bits) - 1;
+	uint i;
+
+	for (i = fdt_cache_hash(cache, phandle);; i = (i + 1) & mask) {
+		ent = &cache->phandles[i];
+		if (ent->phandle == phandle)
+			return ent->offset;
+		if (!ent->phandle)
+			return -FDT_ERR_NOTFOUND;
+	}
+}
+
+static int fdt_cache_build(struct fdt_cache *cache, const void *fdt)
+{
+	struct fdt_cache_phandle *ent;
+	uint32_t phandle;
+	uint size, bits, mask, i;
+	int offset, count = 0;
+
+	for (offset = fdt_next_node(fdt, -1, NULL);
+	     offset >= 0;
+	     offset = fdt_next_node(fdt, offset, NULL)) {
+		phandle = fdt_get_phandle(fdt, offset);
+		if (phandle && phandle != -1)
+			count++;
+	}
+	if (offset != -FDT_ERR_NOTFOUND)
+		return offset;
+
+	/* Keep the index at most half full */
+	for (bits = 4; (1 << bits) < count * 2; bits++)
+		;
+	size = 1 << bits;
+	if (size > cache->size) {
+		free(cache->phandles);
+		cache->size = 0;
+		cache->phandles = malloc(size * sizeof(*cache->phandles));
+		if (!cache->phandles)
+			return -FDT_ERR_NOSPACE;
+		cache->size = size;
+	}
+	memset(cache->phandles, '\0', size * sizeof(*cache->phandles));
+	cache->bits = bits;
+	mask = size - 1;
+
+	for (offset = fdt_next_node(fdt, -1, NULL);
+	     offset >= 0;
+	     offset = fdt_next_node(fdt, offset, NULL)) {
+		phandle = fdt_get_phandle(fdt, offset);
+		if (!phandle || phandle == -1)
+			continue;
+
+		/* The first node with a phandle wins, as with a tree walk */
+		for (i = fdt_cache_hash(cache, phandle);; i = (i + 1) & mask) {
+			ent = &cache->phandles[i];
+			if (!ent->phandle) {
+				ent->phandle = phandle;
+				ent->offset = offset;
+				break;
+			}
+			if (ent->phandle == phandle)
+				break;
+		}
+	}
+
+	return 0;
+}
+
+/* Look for @phandle by walking the tree, as without the cache */
+static int fdt_cache_walk(const void *fdt, uint32_t phandle)
+{
+	int offset;
+
+	for (offset = fdt_next_node(fdt, -1, NULL);
+	     offset >= 0;
+	     offset = fdt_next_node(fdt, offset, NULL)) {
+		if (fdt_get_phandle(fdt, offset) == phandle)
+			return offset;
+	}
+
+	return offset;
+}
+
+int fdt_cache_phandle(const void *fdt, uint32_t phandle, int *offsetp)
+{
+	struct fdt_cache *cache;
+	bool built = false;
+	int offset, ret;
+
+	cache = fdt_cache_get(fdt);
+	if (!cache)
+		return 0;
+
+	if (!cache->bits) {
+		ret = fdt_cache_build(cache, fdt);
+		if (ret == -FDT_ERR_NOSPACE)
+			return 0;
+		if (ret) {
+			*offsetp = ret;
+			return 1;
+		}
+		built = true;
+	}
+
+	offset = fdt_cache_find(cache, phandle);
+	if (offset < 0 && built) {
+		*offsetp = offset;
+		return 1;
+	}
+
+	/*
+	 * A phandle may have been changed in place, or nodes moved without
+	 * changing the size of the tree, so check what we found. If it is
+	 * wrong, build the index again.
+	 */
+	if (offset >= 0 && fdt_get_phandle(fdt, offset) != phandle) {
+		cache->bits = 0;
+		ret = fdt_cache_build(cache, fdt);
+		if (ret == -FDT_ERR_NOSPACE)
+			return 0;
+		*offsetp = ret ? ret : fdt_cache_find(cache, phandle);
+		return 1;
+	}
+
+	/*
+	 * Most lookups which miss are for a phandle which is not there, so
+	 * just walk the tree rather than building the index again. If the
+	 * phandle turns up, the index is out of date, so rebuild it next time.
+	 */
+	if (offset == -FDT_ERR_NOTFOUND) {
+		offset = fdt_cache_walk(fdt, phandle);
+		if (offset >= 0)
+			cache->bits = 0;
+	}
+	*offsetp = offset;
+
+	return 1;
+}
+
+/* Check that the node at @offset has the name at the end of @path */
+static bool fdt_cache_path_ok(const void *fdt, const char *path, int namelen,
+			      int offset)
+{
+	const char *comp, *name;
+	int len, complen;
+
+	comp = path + namelen;
+	while (comp[-1] != '/')
+		comp--;
+	complen = path + namelen - comp;
+
+	name = fdt_get_name(fdt, offset, &len);
+	if (!name || len < complen || memcmp(name, comp, complen))
+		return false;
+
+	return len == complen ||
+		(name[complen] == '@' && !memchr(comp, '@', complen));
+}
+
+int fdt_cache_path(const void *fdt, const char *path, int namelen,
+		   int *offsetp)
+{
+	struct fdt_cache_path *ent;
+	struct fdt_cache *cache;
+	int i;
+
+	if (*path != '/' || namelen >= FDT_CACHE_PATH_LEN)
+		return 0;
+	cache = fdt_cache_get(fdt);
+	if (!cache)
+		return 0;
+
+	for (i = 0; i < FDT_CACHE_PATHS; i++) {
+		ent = &cache->paths[i];
+		if (ent->namelen != namelen || memcmp(ent->path, path, namelen))
+			continue;
+		if (!fdt_cache_path_ok(fdt, path, namelen, ent->offset)) {
+			ent->namelen = 0;
+			return 0;
+		}
+		*offsetp = ent->offset;
+		return 1;
+	}
+
+	return 0;
+}
+
+void fdt_cache_add_path(const void *fdt, const char *path, int namelen,
+			int offset)
+{
+	struct fdt_cache_path *ent;
+	struct fdt_cache *cache;
+
+	/* Only cache plain absolute paths, which can be checked by name */
+	if (*path != '/' || namelen >= FDT_CACHE_PATH_LEN ||
+	    path[namelen - 1] == '/' || memchr(path, ':', namelen))
+		return;
+	/* A node which is not there cannot be checked, so may appear later */
+	if (offset < 0)
+		return;
+	cache = fdt_cache_get(fdt);
+	if (!cache)
+		return;
+
+	ent = &cache->paths[cache->next_path];
+	cache->next_path = (cache->next_path + 1) % FDT_CACHE_PATHS;
+	memcpy(ent->path, path, namelen);
+	ent->namelen = namelen;
+	ent->offset = offset;
+}
+
+void fdt_cache_invalidate(const void *fdt)
+{
+	struct fdt_caches *caches = gd->fdt_cache;
+	int i;
+
+	if (!caches)
+		return;
+	for (i = 0; i < FDT_CACHE_BLOBS; i++) {
+		if (caches->cache[i] && caches->cache[i]->fdt == fdt)
+			caches->cache[i]->fdt = NULL;
+	}
+}
@@ -1,2 +1,823 @@
 #include <linux/libfdt_env.h>
 #include "../../scripts/dtc/libfdt/fdt_overlay.c"
+
+/*
+ * U-Boot addition: apply a list of overlays in one go
+ *
+ * fdt_overlay_apply() looks for the highest phandle, the targets of the
+ * fragments, the labels used by the fixups and the paths of new symbols by
+ * walking the base tree, for each overlay. This does the same operations on
+ * the base tree, in the same order, but walks it once to build an index of
+ * its nodes (by path and phandle) and its symbols, which is then kept up to
+ * date with what each overlay adds.
+ */
+#include <malloc.h>
+
+#define OVL_PATH_MAX	256
+#define OVL_MAX_DEPTH	32
+
+struct ovl_node {
+	char *path;
+	uint32_t phandle;
+};
+
+struct ovl_symbol {
+	char *label;
+	char *path;
+	int node;		/* index in nodes[], -1 if not known */
+};
+
+/* Open-addressed hash table of indexes into nodes[] or symbols[] */
+struct ovl_table {
+	int *slot;
+	unsigned int bits;
+};
+
+struct ovl_index {
+	struct ovl_node *nodes;
+	int node_count;
+	int node_alloc;
+	struct ovl_table by_path;
+	struct ovl_table by_phandle;
+	struct ovl_symbol *symbols;
+	int symbol_count;
+	int symbol_alloc;
+	struct ovl_table by_label;
+	uint32_t max_phandle;
+	bool has_symbols;
+	bool incomplete;	/* out of memory, look up misses in the tree */
+};
+
+static unsigned int ovl_hash_str(const char *str)
+{
+	unsigned int hash = 2166136261u;
+
+	while (*str)
+		hash = (hash ^ (unsigned char)*str++) * 16777619;
+
+	return hash;
+}
+
+static unsigned int ovl_hash_phandle(uint32_t phandle)
+{
+	return phandle * 0x9e3779b1;
+}
+
+static int ovl_table_init(struct ovl_table *tab, unsigned int bits)
+{
+	int *slot;
+
+	slot = malloc(sizeof(*slot) << bits);
+	if (!slot)
+		return -FDT_ERR_NOSPACE;
+	memset(slot, 0xff, sizeof(*slot) << bits);
+	free(tab->slot);
+	tab->slot = slot;
+	tab->bits = bits;
+
+	return 0;
+}
+
+static void ovl_table_insert(struct ovl_table *tab, unsigned int hash, int val)
+{
+	unsigned int mask = (1 << tab->bits) - 1;
+	unsigned int i;
+
+	for (i = hash >> (32 - tab->bits); tab->slot[i] != -1; i = (i + 1) & mask)
+		;
+	tab->slot[i] = val;
+}
+
+static int ovl_node_find(struct ovl_index *idx, const char *path)
+{
+	struct ovl_table *tab = &idx->by_path;
+	unsigned int mask = (1 << tab->bits) - 1;
+	unsigned int i;
+
+	if (!tab->slot)
+		return -1;
+	for (i = ovl_hash_str(path) >> (32 - tab->bits); tab->slot[i] != -1;
+	     i = (i + 1) & mask) {
+		if (!strcmp(idx->nodes[tab->slot[i]].path, path))
+			return tab->slot[i];
+	}
+
+	return -1;
+}
+
+static int ovl_node_by_phandle(struct ovl_index *idx, uint32_t phandle)
+{
+	struct ovl_table *tab = &idx->by_phandle;
+	unsigned int mask = (1 << tab->bits) - 1;
+	unsigned int i;
+
+	if (!tab->slot)
+		return -1;
+	for (i = ovl_hash_phandle(phandle) >> (32 - tab->bits);
+	     tab->slot[i] != -1; i = (i + 1) & mask) {
+		/* Nodes whose phandle was changed are left in the table */
+		if (idx->nodes[tab->slot[i]].phandle == phandle)
+			return tab->slot[i];
+	}
+
+	return -1;
+}
+
+static int ovl_node_rehash(struct ovl_index *idx, unsigned int bits)
+{
+	struct ovl_node *node;
+	int i, ret;
+
+	ret = ovl_table_init(&idx->by_path, bits);
+	if (!ret)
+		ret = ovl_table_init(&idx->by_phandle, bits);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < idx->node_count; i++) {
+		node = &idx->nodes[i];
+		ovl_table_insert(&idx->by_path, ovl_hash_str(node->path), i);
+		if (node->phandle && ovl_node_by_phandle(idx, node->phandle) < 0)
+			ovl_table_insert(&idx->by_phandle,
+					 ovl_hash_phandle(node->phandle), i);
+	}
+
+	return 0;
+}
+
+/* Record that the node at @path has @phandle (0 if none is known) */
+static int ovl_node_add(struct ovl_index *idx, const char *path,
+			uint32_t phandle)
+{
+	struct ovl_node *node;
+	int ret, i;
+
+	if (phandle > idx->max_phandle && phandle != (uint32_t)-1)
+		idx->max_phandle = phandle;
+
+	i = ovl_node_find(idx, path);
+	if (i < 0) {
+		if (idx->node_count == idx->node_alloc) {
+			int alloc = idx->node_alloc ? idx->node_alloc * 2 : 64;
+
+			node = realloc(idx->nodes, alloc * sizeof(*node));
+			if (!node)
+				return -FDT_ERR_NOSPACE;
+			idx->nodes = node;
+			idx->node_alloc = alloc;
+		}
+		if ((idx->node_count + 1) * 2 > (1 << idx->by_path.bits)) {
+			ret = ovl_node_rehash(idx, idx->by_path.bits + 1);
+			if (ret)
+				return ret;
+		}
+		node = &idx->nodes[idx->node_count];
+		node->path = strdup(path);
+		if (!node->path)
+			return -FDT_ERR_NOSPACE;
+		node->phandle = 0;
+		i = idx->node_count++;
+		ovl_table_insert(&idx->by_path, ovl_hash_str(path), i);
+	}
+
+	node = &idx->nodes[i];
+	if (phandle && phandle != (uint32_t)-1 && node->phandle != phandle) {
+		node->phandle = phandle;
+		/* As with a walk of the tree, the first node found wins */
+		if (ovl_node_by_phandle(idx, phandle) < 0)
+			ovl_table_insert(&idx->by_phandle,
+					 ovl_hash_phandle(phandle), i);
+	}
+
+	return i;
+}
+
+static int ovl_symbol_find(struct ovl_index *idx, const char *label)
+{
+	struct ovl_table *tab = &idx->by_label;
+	unsigned int mask = (1 << tab->bits) - 1;
+	unsigned int i;
+
+	if (!tab->slot)
+		return -1;
+	for (i = ovl_hash_str(label) >> (32 - tab->bits); tab->slot[i] != -1;
+	     i = (i + 1) & mask) {
+		if (!strcmp(idx->symbols[tab->slot[i]].label, label))
+			return tab->slot[i];
+	}
+
+	return -1;
+}
+
+/* Record that the symbol @label refers to @path */
+static int ovl_symbol_set(struct ovl_index *idx, const char *label,
+			  const char *path)
+{
+	struct ovl_symbol *sym;
+	char *copy;
+	int ret, i;
+
+	copy = strdup(path);
+	if (!copy)
+		return -FDT_ERR_NOSPACE;
+
+	i = ovl_symbol_find(idx, label);
+	if (i < 0) {
+		if (idx->symbol_count == idx->symbol_alloc) {
+			int alloc = idx->symbol_alloc ?
+				    idx->symbol_alloc * 2 : 64;
+
+			sym = realloc(idx->symbols, alloc * sizeof(*sym));
+			if (!sym)
+				goto err;
+			idx->symbols = sym;
+			idx->symbol_alloc = alloc;
+		}
+		if ((idx->symbol_count + 1) * 2 > (1 << idx->by_label.bits)) {
+			ret = ovl_table_init(&idx->by_label,
+					     idx->by_label.bits + 1);
+			if (ret)
+				goto err;
+			for (i = 0; i < idx->symbol_count; i++)
+				ovl_table_insert(&idx->by_label,
+					ovl_hash_str(idx->symbols[i].label), i);
+		}
+		sym = &idx->symbols[idx->symbol_count];
+		sym->label = strdup(label);
+		if (!sym->label)
+			goto err;
+		i = idx->symbol_count++;
+		ovl_table_insert(&idx->by_label, ovl_hash_str(label), i);
+	} else {
+		free(idx->symbols[i].path);
+	}
+
+	sym = &idx->symbols[i];
+	sym->path = copy;
+	sym->node = ovl_node_find(idx, path);
+
+	return 0;
+
+err:
+	free(copy);
+	return -FDT_ERR_NOSPACE;
+}
+
+static void ovl_index_free(struct ovl_index *idx)
+{
+	int i;
+
+	for (i = 0; i < idx->node_count; i++)
+		free(idx->nodes[i].path);
+	for (i = 0; i < idx->symbol_count; i++) {
+		free(idx->symbols[i].label);
+		free(idx->symbols[i].path);
+	}
+	free(idx->nodes);
+	free(idx->symbols);
+	free(idx->by_path.slot);
+	free(idx->by_phandle.slot);
+	free(idx->by_label.slot);
+}
+
+static int ovl_index_build(struct ovl_index *idx, const void *fdt)
+{
+	int plen[OVL_MAX_DEPTH];
+	char path[OVL_PATH_MAX];
+	const char *name, *value;
+	int offset, depth = -1;
+	int namelen, len, ret;
+	uint32_t phandle;
+
+	memset(idx, '\0', sizeof(*idx));
+	ret = ovl_node_rehash(idx, 6);
+	if (!ret)
+		ret = ovl_table_init(&idx->by_label, 6);
+	if (ret)
+		return ret;
+
+	/* The walk ends with a depth of -1 after the end of the root node */
+	for (offset = fdt_next_node(fdt, -1, &depth);
+	     offset >= 0 && depth >= 0;
+	     offset = fdt_next_node(fdt, offset, &depth)) {
+		phandle = fdt_get_phandle(fdt, offset);
+		name = fdt_get_name(fdt, offset, &namelen);
+		if (!name)
+			return namelen;
+
+		/* Keep track of the path of the node */
+		if (!depth) {
+			plen[0] = 0;
+			strcpy(path, "/");
+		} else if (depth < OVL_MAX_DEPTH && plen[depth - 1] >= 0 &&
+			   plen[depth - 1] + 1 + namelen < OVL_PATH_MAX) {
+			len = plen[depth - 1];
+			path[len++] = '/';
+			memcpy(path + len, name, namelen);
+			plen[depth] = len + namelen;
+			path[plen[depth]] = '\0';
+		} else {
+			/* Too deep to index, so look up misses in the tree */
+			if (depth < OVL_MAX_DEPTH)
+				plen[depth] = -1;
+			if (phandle > idx->max_phandle &&
+			    phandle != (uint32_t)-1)
+				idx->max_phandle = phandle;
+			if (phandle)
+				idx->incomplete = true;
+			continue;
+		}
+
+		if (phandle) {
+			ret = ovl_node_add(idx, path, phandle);
+			if (ret < 0)
+				return ret;
+		}
+	}
+	if (offset < 0 && offset != -FDT_ERR_NOTFOUND)
+		return offset;
+
+	offset = fdt_subnode_offset(fdt, 0, "__symbols__");
+	if (offset == -FDT_ERR_NOTFOUND)
+		return 0;
+	if (offset < 0)
+		return offset;
+	idx->has_symbols = true;
+
+	fdt_for_each_property_offset(offset, fdt, offset) {
+		value = fdt_getprop_by_offset(fdt, offset, &name, &len);
+		if (!value)
+			return len;
+		if (len < 1 || memchr(value, '\0', len) != value + len - 1)
+			continue;
+		ret = ovl_symbol_set(idx, name, value);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* Get the phandle of the node a symbol in the base tree refers to */
+static int ovl_symbol_phandle(struct ovl_index *idx, const void *fdt,
+			      const char *label, uint32_t *phandlep)
+{
+	struct ovl_symbol *sym;
+	const char *path;
+	int i, offset, len;
+
+	*phandlep = 0;
+	i = ovl_symbol_find(idx, label);
+	if (i >= 0 && idx->symbols[i].node >= 0 &&
+	    idx->nodes[idx->symbols[i].node].phandle) {
+		*phandlep = idx->nodes[idx->symbols[i].node].phandle;
+		return 0;
+	}
+
+	if (i >= 0) {
+		sym = &idx->symbols[i];
+		path = sym->path;
+	} else {
+		if (!idx->incomplete)
+			return -FDT_ERR_NOTFOUND;
+		offset = fdt_subnode_offset(fdt, 0, "__symbols__");
+		if (offset < 0)
+			return offset;
+		path = fdt_getprop(fdt, offset, label, &len);
+		if (!path)
+			return len;
+	}
+
+	offset = fdt_path_offset(fdt, path);
+	if (offset < 0)
+		return offset;
+	*phandlep = fdt_get_phandle(fdt, offset);
+
+	return *phandlep ? 0 : -FDT_ERR_NOTFOUND;
+}
+
+/* As overlay_fixup_one_phandle(), but using the index */
+static int ovl_fixup_one_phandle(struct ovl_index *idx, void *fdt,
+				 void *fdto, const char *path,
+				 uint32_t path_len, const char *name,
+				 uint32_t name_len, int poffset,
+				 const char *label)
+{
+	fdt32_t phandle_prop;
+	uint32_t phandle;
+	int fixup_off;
+	int ret;
+
+	if (!idx->has_symbols)
+		return -FDT_ERR_NOTFOUND;
+
+	ret = ovl_symbol_phandle(idx, fdt, label, &phandle);
+	if (ret)
+		return ret;
+
+	fixup_off = fdt_path_offset_namelen(fdto, path, path_len);
+	if (fixup_off == -FDT_ERR_NOTFOUND)
+		return -FDT_ERR_BADOVERLAY;
+	if (fixup_off < 0)
+		return fixup_off;
+
+	phandle_prop = cpu_to_fdt32(phandle);
+	return fdt_setprop_inplace_namelen_partial(fdto, fixup_off,
+						   name, name_len, poffset,
+						   &phandle_prop,
+						   sizeof(phandle_prop));
+}
+
+/* As overlay_fixup_phandle(), but using the index */
+static int ovl_fixup_phandle(struct ovl_index *idx, void *fdt, void *fdto,
+			     int property)
+{
+	const char *value;
+	const char *label;
+	int len;
+
+	value = fdt_getprop_by_offset(fdto, property, &label, &len);
+	if (!value) {
+		if (len == -FDT_ERR_NOTFOUND)
+			return -FDT_ERR_INTERNAL;
+
+		return len;
+	}
+
+	do {
+		const char *path, *name, *fixup_end;
+		const char *fixup_str = value;
+		uint32_t path_len, name_len;
+		uint32_t fixup_len;
+		char *sep, *endptr;
+		int poffset, ret;
+
+		fixup_end = memchr(value, '\0', len);
+		if (!fixup_end)
+			return -FDT_ERR_BADOVERLAY;
+		fixup_len = fixup_end - fixup_str;
+
+		len -= fixup_len + 1;
+		value += fixup_len + 1;
+
+		path = fixup_str;
+		sep = memchr(fixup_str, ':', fixup_len);
+		if (!sep || *sep != ':')
+			return -FDT_ERR_BADOVERLAY;
+
+		path_len = sep - path;
+		if (path_len == (fixup_len - 1))
+			return -FDT_ERR_BADOVERLAY;
+
+		fixup_len -= path_len + 1;
+		name = sep + 1;
+		sep = memchr(name, ':', fixup_len);
+		if (!sep || *sep != ':')
+			return -FDT_ERR_BADOVERLAY;
+
+		name_len = sep - name;
+		if (!name_len)
+			return -FDT_ERR_BADOVERLAY;
+
+		poffset = strtoul(sep + 1, &endptr, 10);
+		if ((*endptr != '\0') || (endptr <= (sep + 1)))
+			return -FDT_ERR_BADOVERLAY;
+
+		ret = ovl_fixup_one_phandle(idx, fdt, fdto, path, path_len,
+					    name, name_len, poffset, label);
+		if (ret)
+			return ret;
+	} while (len > 0);
+
+	return 0;
+}
+
+/* As overlay_fixup_phandles(), but using the index */
+static int ovl_fixup_phandles(struct ovl_index *idx, void *fdt, void *fdto)
+{
+	int fixups_off;
+	int property;
+
+	fixups_off = fdt_path_offset(fdto, "/__fixups__");
+	if (fixups_off == -FDT_ERR_NOTFOUND)
+		return 0;
+	if (fixups_off < 0)
+		return fixups_off;
+
+	fdt_for_each_property_offset(property, fdto, fixups_off) {
+		int ret;
+
+		ret = ovl_fixup_phandle(idx, fdt, fdto, property);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * As overlay_get_target(), but using the index. For a target given by
+ * phandle, this also returns its full path in @fullpathp if it is known.
+ */
+static int ovl_get_target(struct ovl_index *idx, const void *fdt,
+			  const void *fdto, int fragment, const char **pathp,
+			  const char **fullpathp)
+{
+	uint32_t phandle;
+	const char *path = NULL, *fullpath = NULL;
+	int path_len = 0, ret, i;
+
+	phandle = overlay_get_target_phandle(fdto, fragment);
+	if (phandle == (uint32_t)-1)
+		return -FDT_ERR_BADPHANDLE;
+
+	if (!phandle) {
+		path = fdt_getprop(fdto, fragment, "target-path", &path_len);
+		if (path)
+			ret = fdt_path_offset(fdt, path);
+		else
+			ret = path_len;
+	} else {
+		i = ovl_node_by_phandle(idx, phandle);
+		if (i >= 0) {
+			fullpath = idx->nodes[i].path;
+			ret = fdt_path_offset(fdt, fullpath);
+		} else if (idx->incomplete) {
+			ret = fdt_node_offset_by_phandle(fdt, phandle);
+		} else {
+			ret = -FDT_ERR_NOTFOUND;
+		}
+	}
+
+	if (ret < 0 && path_len == -FDT_ERR_NOTFOUND)
+		ret = -FDT_ERR_BADOVERLAY;
+	if (ret < 0)
+		return ret;
+
+	*pathp = path;
+	if (fullpathp)
+		*fullpathp = fullpath;
+
+	return ret;
+}
+
+/*
+ * Note the phandles in an overlay subtree whose paths cannot be indexed.
+ * Later overlays must still get phandles above them.
+ */
+static void ovl_skip_nodes(struct ovl_index *idx, const void *fdto, int node)
+{
+	uint32_t phandle;
+	int depth = 0;
+
+	do {
+		phandle = fdt_get_phandle(fdto, node);
+		if (phandle) {
+			if (phandle > idx->max_phandle &&
+			    phandle != (uint32_t)-1)
+				idx->max_phandle = phandle;
+			idx->incomplete = true;
+		}
+		node = fdt_next_node(fdto, node, &depth);
+	} while (node >= 0 && depth > 0);
+}
+
+/* Add the nodes with a phandle merged from an overlay node to the index */
+static void ovl_add_nodes(struct ovl_index *idx, const void *fdto, int node,
+			  char *path, int len)
+{
+	const char *name;
+	uint32_t phandle;
+	int child, namelen, plen;
+
+	phandle = fdt_get_phandle(fdto, node);
+	if (phandle && ovl_node_add(idx, path, phandle) < 0)
+		idx->incomplete = true;
+
+	/* The path of the root node is "/", not "" */
+	plen = len > 1 ? len : 0;
+	fdt_for_each_subnode(child, fdto, node) {
+		name = fdt_get_name(fdto, child, &namelen);
+		if (!name || plen + 1 + namelen >= OVL_PATH_MAX) {
+			ovl_skip_nodes(idx, fdto, child);
+			continue;
+		}
+		path[plen] = '/';
+		memcpy(path + plen + 1, name, namelen);
+		path[plen + 1 + namelen] = '\0';
+		ovl_add_nodes(idx, fdto, child, path, plen + 1 + namelen);
+		path[len] = '\0';
+	}
+}
+
+/* As overlay_merge(), but using and updating the index */
+static int ovl_merge(struct ovl_index *idx, void *fdt, void *fdto)
+{
+	const char *target_path, *fullpath;
+	char path[OVL_PATH_MAX];
+	int fragment;
+
+	fdt_for_each_subnode(fragment, fdto, 0) {
+		int overlay;
+		int target;
+		int ret;
+
+		overlay = fdt_subnode_offset(fdto, fragment, "__overlay__");
+		if (overlay == -FDT_ERR_NOTFOUND)
+			continue;
+
+		if (overlay < 0)
+			return overlay;
+
+		target = ovl_get_target(idx, fdt, fdto, fragment, &target_path,
+					&fullpath);
+		if (target < 0)
+			return target;
+
+		ret = overlay_apply_node(fdt, target, fdto, overlay);
+		if (ret)
+			return ret;
+
+		/*
+		 * Merging adds to the target node, so its offset is still
+		 * valid. The index holds full paths, so look up the path of a
+		 * target given by path.
+		 */
+		if (fullpath && strlen(fullpath) < OVL_PATH_MAX) {
+			strcpy(path, fullpath);
+		} else if (fdt_get_path(fdt, target, path, OVL_PATH_MAX)) {
+			ovl_skip_nodes(idx, fdto, overlay);
+			continue;
+		}
+		ovl_add_nodes(idx, fdto, overlay, path, strlen(path));
+	}
+
+	return 0;
+}
+
+/* As overlay_symbol_update(), but using and updating the index */
+static int ovl_symbol_update(struct ovl_index *idx, void *fdt, void *fdto)
+{
+	int root_sym, ov_sym, prop, path_len, fragment, target;
+	int len, frag_name_len, ret, rel_path_len;
+	char buf[OVL_PATH_MAX];
+	const char *s, *e;
+	const char *path;
+	const char *name;
+	const char *frag_name;
+	const char *rel_path;
+	const char *target_path, *fullpath;
+	char *str;
+	void *p;
+
+	ov_sym = fdt_subnode_offset(fdto, 0, "__symbols__");
+	if (ov_sym < 0)
+		return 0;
+
+	root_sym = fdt_subnode_offset(fdt, 0, "__symbols__");
+	if (root_sym == -FDT_ERR_NOTFOUND)
+		root_sym = fdt_add_subnode(fdt, 0, "__symbols__");
+	if (root_sym < 0)
+		return root_sym;
+	idx->has_symbols = true;
+
+	fdt_for_each_property_offset(prop, fdto, ov_sym) {
+		path = fdt_getprop_by_offset(fdto, prop, &name, &path_len);
+		if (!path)
+			return path_len;
+
+		if (path_len < 1 ||
+		    memchr(path, '\0', path_len) != &path[path_len - 1])
+			return -FDT_ERR_BADVALUE;
+
+		e = path + path_len;
+
+		if (*path != '/')
+			return -FDT_ERR_BADVALUE;
+
+		s = strchr(path + 1, '/');
+		if (!s)
+			return -FDT_ERR_BADOVERLAY;
+
+		frag_name = path + 1;
+		frag_name_len = s - path - 1;
+
+		len = sizeof("/__overlay__/") - 1;
+		if ((e - s) < len || memcmp(s, "/__overlay__/", len))
+			return -FDT_ERR_BADOVERLAY;
+
+		rel_path = s + len;
+		rel_path_len = e - rel_path;
+
+		ret = fdt_subnode_offset_namelen(fdto, 0, frag_name,
+						 frag_name_len);
+		if (ret < 0)
+			return -FDT_ERR_BADOVERLAY;
+		fragment = ret;
+
+		ret = fdt_subnode_offset(fdto, fragment, "__overlay__");
+		if (ret < 0)
+			return -FDT_ERR_BADOVERLAY;
+
+		ret = ovl_get_target(idx, fdt, fdto, fragment, &target_path,
+				     &fullpath);
+		if (ret < 0)
+			return ret;
+		target = ret;
+
+		/*
+		 * fdt_overlay_apply() uses the full path of a target given by
+		 * phandle, which the index normally has
+		 */
+		if (!target_path)
+			target_path = fullpath;
+		if (!target_path) {
+			ret = fdt_get_path(fdt, target, buf, sizeof(buf));
+			if (ret < 0)
+				return ret;
+			target_path = buf;
+		}
+		len = strlen(target_path);
+
+		ret = fdt_setprop_placeholder(fdt, root_sym, name,
+				len + (len > 1) + rel_path_len + 1, &p);
+		if (ret < 0)
+			return ret;
+
+		str = p;
+		if (len > 1)
+			memcpy(str, target_path, len);
+		else
+			len--;
+
+		str[len] = '/';
+		memcpy(str + len + 1, rel_path, rel_path_len);
+		str[len + 1 + rel_path_len] = '\0';
+
+		if (ovl_symbol_set(idx, name, str))
+			idx->incomplete = true;
+	}
+
+	return 0;
+}
+
+static int ovl_apply(struct ovl_index *idx, void *fdt, void *fdto)
+{
+	uint32_t delta = idx->max_phandle;
+	int ret;
+
+	ret = overlay_adjust_local_phandles(fdto, delta);
+	if (ret)
+		return ret;
+
+	ret = overlay_update_local_references(fdto, delta);
+	if (ret)
+		return ret;
+
+	ret = ovl_fixup_phandles(idx, fdt, fdto);
+	if (ret)
+		return ret;
+
+	ret = ovl_merge(idx, fdt, fdto);
+	if (ret)
+		return ret;
+
+	return ovl_symbol_update(idx, fdt, fdto);
+}
+
+int fdt_overlay_apply_list(void *fdt, void * const fdtos[], int count)
+{
+	struct ovl_index idx;
+	int ret, i;
+
+	FDT_CHECK_HEADER(fdt);
+	for (i = 0; i < count; i++)
+		FDT_CHECK_HEADER(fdtos[i]);
+
+	ret = ovl_index_build(&idx, fdt);
+	if (ret == -FDT_ERR_NOSPACE) {
+		/* Not enough memory for the index; do it the slow way */
+		ovl_index_free(&idx);
+		for (i = 0; i < count; i++) {
+			ret = fdt_overlay_apply(fdt, fdtos[i]);
+			if (ret)
+				return ret;
+		}
+
+		return 0;
+	}
+
+	for (i = 0; !ret && i < count; i++) {
+		ret = ovl_apply(&idx, fdt, fdtos[i]);
+
+		/* The overlay has been damaged, erase its magic */
+		fdt_set_magic(fdtos[i], ~0);
+	}
+	ovl_index_free(&idx);
+
+	/* The base device tree might have been damaged, erase its magic */
+	if (ret)
+		fdt_set_magic(fdt, ~0);
+
+	return ret;
+}
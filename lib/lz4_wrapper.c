@@ -5,8 +5,11 @@
 
 #include <common.h>
 #include <compiler.h>
+#include <lz4.h>
+#include <malloc.h>
 #include <linux/kernel.h>
 #include <linux/types.h>
+#include <asm/unaligned.h>
 
 static u16 LZ4_readLE16(const void *src) { return le16_to_cpu(*(u16 *)src); }
 static void LZ4_copy4(void *dst, const void *src) { *(u32 *)dst = *(u32 *)src; }
@@ -62,77 +65,249 @@ struct lz4_block_header {
 	/* + u32 block_checksum iff has_block_checksum is set */
 } __packed;
 
-int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
+enum {
+	ULZ4_FRAME_HEADER,
+	ULZ4_BLOCK_HEADER,
+	ULZ4_BLOCK,
+	ULZ4_DONE,
+};
+
+void ulz4_stream_init(struct ulz4_stream *s, void *dst, size_t dstn)
+{
+	memset(s, 0, sizeof(*s));
+	s->dst = dst;
+	s->out = dst;
+	s->end = dst + dstn;
+	s->state = ULZ4_FRAME_HEADER;
+}
+
+/* Collect the first @len bytes of a header in s->hdr, true once complete */
+static bool ulz4_gather(struct ulz4_stream *s, const u8 **in, size_t *inn,
+			size_t len)
+{
+	size_t n;
+
+	if (s->hdr_len >= len)
+		return true;
+	n = min(len - s->hdr_len, *inn);
+
+	memcpy(s->hdr + s->hdr_len, *in, n);
+	s->hdr_len += n;
+	*in += n;
+	*inn -= n;
+
+	return s->hdr_len == len;
+}
+
+static int ulz4_frame_header(struct ulz4_stream *s)
+{
+	const struct lz4_frame_header *h = (void *)s->hdr;
+
+	/* We assume there's always only a single, standard frame. */
+	if (le32_to_cpu(h->magic) != LZ4F_MAGIC || h->version != 1)
+		return -EPROTONOSUPPORT;	/* unknown format */
+	if (h->reserved0 || h->reserved1 || h->reserved2)
+		return -EINVAL;	/* reserved must be zero */
+	if (h->max_block_size < 4)
+		return -EINVAL;	/* reserved block size */
+
+	s->block_max = 1 << (8 + 2 * h->max_block_size);
+	s->independent_blocks = h->independent_blocks;
+	s->has_block_checksum = h->has_block_checksum;
+	s->has_content_checksum = h->has_content_checksum;
+
+	return 0;
+}
+
+static int ulz4_block_header(struct ulz4_stream *s)
+{
+	struct lz4_block_header b;
+
+	b.raw = get_unaligned_le32(s->hdr);
+	if (!b.size) {
+		/* end mark, perhaps followed by the content checksum */
+		if (s->has_content_checksum)
+			s->skip = sizeof(u32);
+		s->state = ULZ4_DONE;
+		return 0;
+	}
+	if (b.size > s->block_max)
+		return -EINVAL;
+
+	s->block = b.raw;
+	s->buf_len = 0;
+	s->state = ULZ4_BLOCK;
+
+	return 0;
+}
+
+/* Decompress a complete block of @size bytes at @in */
+static int ulz4_block(struct ulz4_stream *s, const u8 *in, u32 size)
 {
-	const void *end = dst + *dstn;
-	const void *in = src;
-	void *out = dst;
-	int has_block_checksum;
 	int ret;
-	*dstn = 0;
 
-	{ /* With in-place decompression the header may become invalid later. */
-		const struct lz4_frame_header *h = in;
+	/*
+	 * Linked blocks may refer back to earlier blocks, all of which are
+	 * still in the output buffer.
+	 */
+	if (s->independent_blocks)
+		ret = LZ4_decompress_generic((const char *)in, (char *)s->out,
+					     size, s->end - s->out,
+					     endOnInputSize, full, 0, noDict,
+					     s->out, NULL, 0);
+	else
+		ret = LZ4_decompress_generic((const char *)in, (char *)s->out,
+					     size, s->end - s->out,
+					     endOnInputSize, full, 0,
+					     withPrefix64k, s->dst, NULL, 0);
+	if (ret < 0)
+		return -EPROTO;	/* decompression error */
+	s->out += ret;
 
-		if (srcn < sizeof(*h) + sizeof(u64) + sizeof(u8))
-			return -EINVAL;	/* input overrun */
+	return 0;
+}
 
-		/* We assume there's always only a single, standard frame. */
-		if (le32_to_cpu(h->magic) != LZ4F_MAGIC || h->version != 1)
-			return -EPROTONOSUPPORT;	/* unknown format */
-		if (h->reserved0 || h->reserved1 || h->reserved2)
-			return -EINVAL;	/* reserved must be zero */
-		if (!h->independent_blocks)
-			return -EPROTONOSUPPORT; /* we can't support this yet */
-		has_block_checksum = h->has_block_checksum;
-
-		in += sizeof(*h);
-		if (h->has_content_size)
-			in += sizeof(u64);
-		in += sizeof(u8);
+/*
+ * Get a buffer for a block which is split between two chunks. Try for the
+ * frame's maximum block size first, so that one buffer does for every block,
+ * then fall back to the size of this block if the malloc() pool is too small.
+ */
+static int ulz4_get_buf(struct ulz4_stream *s, size_t size)
+{
+	free(s->buf);
+	s->buf_size = s->block_max;
+	s->buf = malloc(s->buf_size);
+	if (!s->buf) {
+		s->buf_size = size;
+		s->buf = malloc(s->buf_size);
+	}
+	if (!s->buf) {
+		s->buf_size = 0;
+		return -ENOMEM;
 	}
 
-	while (1) {
-		struct lz4_block_header b;
+	return 0;
+}
 
-		b.raw = le32_to_cpu(*(u32 *)in);
-		in += sizeof(struct lz4_block_header);
+/* Consume up to *inn bytes of the current block's data */
+static int ulz4_block_data(struct ulz4_stream *s, const u8 **in, size_t *inn)
+{
+	struct lz4_block_header b = { .raw = s->block };
+	size_t n = min(b.size - s->buf_len, *inn);
+	int ret = 0;
 
-		if (in - src + b.size > srcn) {
-			ret = -EINVAL;		/* input overrun */
-			break;
+	if (b.not_compressed) {
+		/* copy straight to the output, however little there is */
+		if (n > s->end - s->out) {
+			n = s->end - s->out;
+			ret = -ENOBUFS;	/* output overrun */
 		}
+		memcpy(s->out, *in, n);
+		s->out += n;
+		s->buf_len += n;
+	} else if (!s->buf_len && n == b.size) {
+		/* the whole block is here, so no need to buffer it */
+		ret = ulz4_block(s, *in, b.size);
+		s->buf_len = n;
+	} else {
+		/* the rest of the block will never come, so don't buffer it */
+		if (s->whole)
+			return -EINVAL;	/* input overrun */
+		if (s->buf_size < b.size) {
+			ret = ulz4_get_buf(s, b.size);
+			if (ret)
+				return ret;
+		}
+		memcpy(s->buf + s->buf_len, *in, n);
+		s->buf_len += n;
+		if (s->buf_len == b.size)
+			ret = ulz4_block(s, s->buf, b.size);
+	}
+	*in += n;
+	*inn -= n;
+	if (ret)
+		return ret;
 
-		if (!b.size) {
-			ret = 0;	/* decompression successful */
-			break;
+	if (s->buf_len == b.size) {
+		if (s->has_block_checksum)
+			s->skip = sizeof(u32);
+		s->hdr_len = 0;
+		s->state = ULZ4_BLOCK_HEADER;
+	}
+
+	return 0;
+}
+
+int ulz4_stream_feed(struct ulz4_stream *s, const void *src, size_t srcn)
+{
+	const u8 *in = src;
+	size_t n;
+
+	while (srcn && !s->err) {
+		if (s->skip) {
+			/* a checksum, which we don't verify */
+			n = min_t(size_t, s->skip, srcn);
+			s->skip -= n;
+			in += n;
+			srcn -= n;
+			continue;
 		}
 
-		if (b.not_compressed) {
-			size_t size = min((ptrdiff_t)b.size, end - out);
-			memcpy(out, in, size);
-			out += size;
-			if (size < b.size) {
-				ret = -ENOBUFS;	/* output overrun */
+		switch (s->state) {
+		case ULZ4_FRAME_HEADER:
+			n = sizeof(struct lz4_frame_header) + sizeof(u8);
+			if (!ulz4_gather(s, &in, &srcn, n))
 				break;
-			}
-		} else {
-			/* constant folding essential, do not touch params! */
-			ret = LZ4_decompress_generic(in, out, b.size,
-					end - out, endOnInputSize,
-					full, 0, noDict, out, NULL, 0);
-			if (ret < 0) {
-				ret = -EPROTO;	/* decompression error */
+			if (((struct lz4_frame_header *)s->hdr)->has_content_size &&
+			    !ulz4_gather(s, &in, &srcn, n + sizeof(u64)))
 				break;
-			}
-			out += ret;
+			s->err = ulz4_frame_header(s);
+			s->hdr_len = 0;
+			s->state = ULZ4_BLOCK_HEADER;
+			break;
+		case ULZ4_BLOCK_HEADER:
+			if (ulz4_gather(s, &in, &srcn,
+					sizeof(struct lz4_block_header)))
+				s->err = ulz4_block_header(s);
+			break;
+		case ULZ4_BLOCK:
+			s->err = ulz4_block_data(s, &in, &srcn);
+			break;
+		case ULZ4_DONE:
+			/* ignore anything after the frame */
+			return 0;
 		}
-
-		in += b.size;
-		if (has_block_checksum)
-			in += sizeof(u32);
 	}
 
-	*dstn = out - dst;
-	return ret;
+	return s->err;
+}
+
+int ulz4_stream_finish(struct ulz4_stream *s, size_t *dstn)
+{
+	*dstn = s->out - s->dst;
+	free(s->buf);
+	s->buf = NULL;
+	s->buf_size = 0;
+
+	if (s->err)
+		return s->err;
+	if (s->state != ULZ4_DONE)
+		return -EINVAL;	/* input overrun */
+
+	return 0;
+}
+
+int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
+{
+	struct ulz4_stream s;
+
+	/*
+	 * With in-place decompression the input may be overwritten later, but
+	 * each block is only read before the output reaches it.
+	 */
+	ulz4_stream_init(&s, dst, *dstn);
+	s.whole = true;
+	ulz4_stream_feed(&s, src, srcn);
+
+	return ulz4_stream_finish(&s, dstn);
 }
@@ -21,7 +21,7 @@
 #include <common.h>
 #include <watchdog.h>
 
-#ifdef CONFIG_LZMA
+#if CONFIG_IS_ENABLED(LZMA)
 
 #define LZMA_PROPERTIES_OFFSET 0
 #define LZMA_SIZE_OFFSET       LZMA_PROPS_SIZE
@@ -36,33 +36,23 @@
 static void *SzAlloc(void *p, size_t size) { return malloc(size); }
 static void SzFree(void *p, void *address) { free(address); }
 
-int lzmaBuffToBuffDecompress (unsigned char *outStream, SizeT *uncompressedSize,
-                  unsigned char *inStream,  SizeT  length)
-{
-    int res = SZ_ERROR_DATA;
-    int i;
-    ISzAlloc g_Alloc;
+static ISzAlloc g_Alloc = { SzAlloc, SzFree };
 
-    SizeT outSizeFull = 0xFFFFFFFF; /* 4GBytes limit */
-    SizeT outProcessed;
+/* Parse the LZMA_Alone header and set up the decoder to write to the dic */
+static int lzma_stream_start(struct lzma_stream *s)
+{
+    unsigned char *dic = s->dec.dic;
+    SizeT outSizeFull;
     SizeT outSize;
     SizeT outSizeHigh;
-    ELzmaStatus state;
-    SizeT compressedSize = (SizeT)(length - LZMA_PROPS_SIZE);
-
-    debug ("LZMA: Image address............... 0x%p\n", inStream);
-    debug ("LZMA: Properties address.......... 0x%p\n", inStream + LZMA_PROPERTIES_OFFSET);
-    debug ("LZMA: Uncompressed size address... 0x%p\n", inStream + LZMA_SIZE_OFFSET);
-    debug ("LZMA: Compressed data address..... 0x%p\n", inStream + LZMA_DATA_OFFSET);
-    debug ("LZMA: Destination address......... 0x%p\n", outStream);
-
-    memset(&state, 0, sizeof(state));
+    int res;
+    int i;
 
     outSize = 0;
     outSizeHigh = 0;
     /* Read the uncompressed size */
     for (i = 0; i < 8; i++) {
-        unsigned char b = inStream[LZMA_SIZE_OFFSET + i];
+        unsigned char b = s->hdr[LZMA_SIZE_OFFSET + i];
             if (i < 4) {
                 outSize     += (UInt32)(b) << (i * 8);
         } else {
@@ -91,32 +81,106 @@ int lzmaBuffToBuffDecompress (unsigned char *outStream, SizeT *uncompressedSize,
     }
 
     debug("LZMA: Uncompresed size............ 0x%zx\n", outSizeFull);
-    debug("LZMA: Compresed size.............. 0x%zx\n", compressedSize);
-
-    g_Alloc.Alloc = SzAlloc;
-    g_Alloc.Free = SzFree;
 
     /* Short-circuit early if we know the buffer can't hold the results. */
-    if (outSizeFull != (SizeT)-1 && *uncompressedSize < outSizeFull)
+    if (outSizeFull != (SizeT)-1 && s->out_size < outSizeFull)
         return SZ_ERROR_OUTPUT_EOF;
 
-    /* Decompress */
-    outProcessed = min(outSizeFull, *uncompressedSize);
+    res = LzmaDec_AllocateProbs(&s->dec, s->hdr + LZMA_PROPERTIES_OFFSET,
+                                LZMA_PROPS_SIZE, &g_Alloc);
+    if (res != SZ_OK)
+        return res;
 
-    WATCHDOG_RESET();
+    /* The output buffer is the dictionary, so no history is ever copied */
+    s->dec.dic = dic;
+    s->dec.dicBufSize = min(outSizeFull, s->out_size);
+    LzmaDec_Init(&s->dec);
 
-    res = LzmaDecode(
-        outStream, &outProcessed,
-        inStream + LZMA_DATA_OFFSET, &compressedSize,
-        inStream, LZMA_PROPS_SIZE, LZMA_FINISH_END, &state, &g_Alloc);
-    *uncompressedSize = outProcessed;
+    return SZ_OK;
+}
 
-    debug("LZMA: Uncompressed ............... 0x%zx\n", outProcessed);
+void lzma_stream_init(struct lzma_stream *s, unsigned char *outStream,
+                      SizeT outSize)
+{
+    memset(s, 0, sizeof(*s));
+    LzmaDec_Construct(&s->dec);
+    s->dec.dic = outStream;
+    s->out_size = outSize;
+    s->status = LZMA_STATUS_NOT_SPECIFIED;
+}
 
-    if (res != SZ_OK)  {
-        return res;
+int lzma_stream_feed(struct lzma_stream *s, const unsigned char *inStream,
+                     SizeT length)
+{
+    SizeT len;
+
+    if (s->res != SZ_OK)
+        return s->res;
+
+    if (s->hdr_len < LZMA_HEADER_SIZE) {
+        len = min(length, (SizeT)(LZMA_HEADER_SIZE - s->hdr_len));
+        memcpy(s->hdr + s->hdr_len, inStream, len);
+        s->hdr_len += len;
+        inStream += len;
+        length -= len;
+        if (s->hdr_len < LZMA_HEADER_SIZE)
+            return SZ_OK;
+
+        s->res = lzma_stream_start(s);
+        if (s->res != SZ_OK)
+            return s->res;
     }
 
+    /* Ignore anything after the end of the stream, e.g. sector padding */
+    if (s->status == LZMA_STATUS_FINISHED_WITH_MARK ||
+        s->status == LZMA_STATUS_MAYBE_FINISHED_WITHOUT_MARK)
+        return SZ_OK;
+
+    WATCHDOG_RESET();
+
+    /*
+     * Partial input is buffered inside the decoder, so every byte of a
+     * chunk is consumed unless the end of the stream is reached.
+     */
+    s->res = LzmaDec_DecodeToDic(&s->dec, s->dec.dicBufSize, inStream,
+                                 &length, LZMA_FINISH_END, &s->status);
+
+    return s->res;
+}
+
+int lzma_stream_finish(struct lzma_stream *s, SizeT *uncompressedSize)
+{
+    int res = s->res;
+
+    if (res == SZ_OK && (s->hdr_len < LZMA_HEADER_SIZE ||
+                         s->status == LZMA_STATUS_NOT_SPECIFIED ||
+                         s->status == LZMA_STATUS_NEEDS_MORE_INPUT))
+        res = SZ_ERROR_INPUT_EOF;
+
+    *uncompressedSize = s->dec.dicPos;
+    LzmaDec_FreeProbs(&s->dec, &g_Alloc);
+
+    debug("LZMA: Uncompressed ............... 0x%zx\n", *uncompressedSize);
+
+    return res;
+}
+
+int lzmaBuffToBuffDecompress (unsigned char *outStream, SizeT *uncompressedSize,
+                  unsigned char *inStream,  SizeT  length)
+{
+    struct lzma_stream s;
+    int res;
+
+    debug ("LZMA: Image address............... 0x%p\n", inStream);
+    debug ("LZMA: Properties address.......... 0x%p\n", inStream + LZMA_PROPERTIES_OFFSET);
+    debug ("LZMA: Uncompressed size address... 0x%p\n", inStream + LZMA_SIZE_OFFSET);
+    debug ("LZMA: Compressed data address..... 0x%p\n", inStream + LZMA_DATA_OFFSET);
+    debug ("LZMA: Destination address......... 0x%p\n", outStream);
+
+    lzma_stream_init(&s, outStream, *uncompressedSize);
+    lzma_stream_feed(&s, inStream, length);
+    res = lzma_stream_finish(&s, uncompressedSize);
+
     return res;
 }
 
@@ -12,6 +12,68 @@
 #define __LZMA_TOOL_H__
 
 #include <lzma/LzmaTypes.h>
+#include <lzma/LzmaDec.h>
+
+/* Properties plus the 64-bit uncompressed size of an LZMA_Alone header */
+#define LZMA_HEADER_SIZE	(LZMA_PROPS_SIZE + 8)
+
+/**
+ * struct lzma_stream - state of an incremental LZMA_Alone decode
+ *
+ * The output buffer doubles as the LZMA dictionary, so input can be fed in
+ * chunks of any size (e.g. as sectors arrive from a block device) without
+ * ever holding the whole compressed image in memory.
+ *
+ * @dec:	LZMA decoder state
+ * @res:	First error seen (SZ_OK if none)
+ * @status:	Decoder status after the last chunk
+ * @out_size:	Size of the output buffer
+ * @hdr_len:	Number of header bytes gathered so far
+ * @hdr:	LZMA_Alone header (properties and uncompressed size)
+ */
+struct lzma_stream {
+	CLzmaDec dec;
+	int res;
+	ELzmaStatus status;
+	SizeT out_size;
+	unsigned int hdr_len;
+	unsigned char hdr[LZMA_HEADER_SIZE];
+};
+
+/**
+ * lzma_stream_init() - Start an incremental LZMA_Alone decode
+ *
+ * @s:		Stream state to set up
+ * @outStream:	Buffer for the uncompressed data
+ * @outSize:	Size of @outStream in bytes
+ */
+void lzma_stream_init(struct lzma_stream *s, unsigned char *outStream,
+		      SizeT outSize);
+
+/**
+ * lzma_stream_feed() - Decompress the next chunk of an LZMA_Alone stream
+ *
+ * Any data following the end of the stream is ignored, so callers may feed
+ * whole sectors.
+ *
+ * @s:		Stream state
+ * @inStream:	Next chunk of compressed data
+ * @length:	Size of @inStream in bytes
+ * @return SZ_OK if OK, SZ_ERROR_... on error
+ */
+int lzma_stream_feed(struct lzma_stream *s, const unsigned char *inStream,
+		     SizeT length);
+
+/**
+ * lzma_stream_finish() - Complete an LZMA_Alone decode and free its state
+ *
+ * This must be called once for every lzma_stream_init(), even after an error.
+ *
+ * @s:			Stream state
+ * @uncompressedSize:	Returns the number of bytes decompressed
+ * @return SZ_OK if the stream was complete, SZ_ERROR_... otherwise
+ */
+int lzma_stream_finish(struct lzma_stream *s, SizeT *uncompressedSize);
 
 extern int lzmaBuffToBuffDecompress (unsigned char *outStream, SizeT *uncompressedSize,
 			      unsigned char *inStream,  SizeT  length);
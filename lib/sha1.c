@@ -19,6 +19,7 @@
 #ifndef USE_HOSTCC
 #include <common.h>
 #include <linux/string.h>
+#include <u-boot/sha_engine.h>
 #else
 #include <string.h>
 #endif /* USE_HOSTCC */
@@ -63,6 +64,12 @@ void sha1_starts (sha1_context * ctx)
 	ctx->state[2] = 0x98BADCFE;
 	ctx->state[3] = 0x10325476;
 	ctx->state[4] = 0xC3D2E1F0;
+
+#if defined(CONFIG_SHA_ENGINE) && !defined(USE_HOSTCC)
+	ctx->engine = sha_engine_find(SHA_ENGINE_SHA1);
+#else
+	ctx->engine = NULL;
+#endif
 }
 
 static void sha1_process(sha1_context *ctx, const unsigned char data[64])
@@ -219,6 +226,30 @@ static void sha1_process(sha1_context *ctx, const unsigned char data[64])
 	ctx->state[4] += E;
 }
 
+static void sha1_process_blocks(sha1_context *ctx, const unsigned char *data,
+				unsigned int blocks)
+{
+#if defined(CONFIG_SHA_ENGINE) && !defined(USE_HOSTCC)
+	const struct sha_engine *engine = ctx->engine;
+	uint32_t state[5];
+	int i;
+
+	if (engine) {
+		/* The context holds the state in unsigned longs */
+		for (i = 0; i < 5; i++)
+			state[i] = ctx->state[i];
+		engine->sha1_blocks(state, data, blocks);
+		for (i = 0; i < 5; i++)
+			ctx->state[i] = state[i];
+		return;
+	}
+#endif
+	while (blocks--) {
+		sha1_process(ctx, data);
+		data += 64;
+	}
+}
+
 /*
  * SHA-1 process buffer
  */
@@ -242,16 +273,16 @@ void sha1_update(sha1_context *ctx, const unsigned char *input,
 
 	if (left && ilen >= fill) {
 		memcpy ((void *) (ctx->buffer + left), (void *) input, fill);
-		sha1_process (ctx, ctx->buffer);
+		sha1_process_blocks(ctx, ctx->buffer, 1);
 		input += fill;
 		ilen -= fill;
 		left = 0;
 	}
 
-	while (ilen >= 64) {
-		sha1_process (ctx, input);
-		input += 64;
-		ilen -= 64;
+	if (ilen >= 64) {
+		sha1_process_blocks(ctx, input, ilen / 64);
+		input += ilen & ~0x3f;
+		ilen &= 0x3f;
 	}
 
 	if (ilen > 0) {
@@ -8,6 +8,7 @@
 #ifndef USE_HOSTCC
 #include <common.h>
 #include <linux/string.h>
+#include <u-boot/sha_engine.h>
 #else
 #include <string.h>
 #endif /* USE_HOSTCC */
@@ -53,6 +54,12 @@ void sha256_starts(sha256_context * ctx)
 	ctx->state[5] = 0x9B05688C;
 	ctx->state[6] = 0x1F83D9AB;
 	ctx->state[7] = 0x5BE0CD19;
+
+#if defined(CONFIG_SHA_ENGINE) && !defined(USE_HOSTCC)
+	ctx->engine = sha_engine_find(SHA_ENGINE_SHA256);
+#else
+	ctx->engine = NULL;
+#endif
 }
 
 static void sha256_process(sha256_context *ctx, const uint8_t data[64])
@@ -186,6 +193,21 @@ static void sha256_process(sha256_context *ctx, const uint8_t data[64])
 	ctx->state[7] += H;
 }
 
+static void sha256_process_blocks(sha256_context *ctx, const uint8_t *data,
+				  uint32_t blocks)
+{
+#if defined(CONFIG_SHA_ENGINE) && !defined(USE_HOSTCC)
+	if (ctx->engine) {
+		ctx->engine->sha256_blocks(ctx->state, data, blocks);
+		return;
+	}
+#endif
+	while (blocks--) {
+		sha256_process(ctx, data);
+		data += 64;
+	}
+}
+
 void sha256_update(sha256_context *ctx, const uint8_t *input, uint32_t length)
 {
 	uint32_t left, fill;
@@ -204,16 +226,16 @@ void sha256_update(sha256_context *ctx, const uint8_t *input, uint32_t length)
 
 	if (left && length >= fill) {
 		memcpy((void *) (ctx->buffer + left), (void *) input, fill);
-		sha256_process(ctx, ctx->buffer);
+		sha256_process_blocks(ctx, ctx->buffer, 1);
 		length -= fill;
 		input += fill;
 		left = 0;
 	}
 
-	while (length >= 64) {
-		sha256_process(ctx, input);
-		length -= 64;
-		input += 64;
+	if (length >= 64) {
+		sha256_process_blocks(ctx, input, length / 64);
+		input += length & ~0x3f;
+		length &= 0x3f;
 	}
 
 	if (length)
@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Pluggable SHA-1/SHA-256 block transforms
+ */
+
+#include <common.h>
+#include <u-boot/sha_engine.h>
+
+const struct sha_engine *sha_engine_find(enum sha_engine_algo algo)
+{
+	struct sha_engine *start =
+		ll_entry_start(struct sha_engine, sha_engine);
+	const int n_ents = ll_entry_count(struct sha_engine, sha_engine);
+	struct sha_engine *engine;
+
+	for (engine = start; engine != start + n_ents; engine++) {
+		if (algo == SHA_ENGINE_SHA1 && !engine->sha1_blocks)
+			continue;
+		if (algo == SHA_ENGINE_SHA256 && !engine->sha256_blocks)
+			continue;
+		if (!engine->probe || engine->probe())
+			return engine;
+	}
+
+	return NULL;
+}
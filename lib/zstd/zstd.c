@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * U-Boot wrapper for the zstd decoder
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <linux/errno.h>
+#include "zstd.h"
+
+int zstd_decompress(const void *src, size_t srcn, void *dst, size_t *dstn)
+{
+	ZSTD_DCtx *dctx;
+	size_t ret;
+
+	dctx = ZSTD_createDCtx();
+	if (!dctx) {
+		*dstn = 0;
+		return -ENOMEM;
+	}
+
+	/* this handles any number of concatenated frames */
+	ret = ZSTD_decompressDCtx(dctx, dst, *dstn, src, srcn);
+	ZSTD_freeDCtx(dctx);
+
+	if (!ZSTD_isError(ret)) {
+		*dstn = ret;
+		return 0;
+	}
+
+	debug("%s: %s\n", __func__, ZSTD_getErrorName(ret));
+	switch (ZSTD_getErrorCode(ret)) {
+	case ZSTD_error_dstSize_tooSmall:
+		/* the whole buffer was used */
+		return -ENOBUFS;
+	case ZSTD_error_memory_allocation:
+		*dstn = 0;
+		return -ENOMEM;
+	case ZSTD_error_prefix_unknown:
+	case ZSTD_error_version_unsupported:
+	case ZSTD_error_frameParameter_unsupported:
+		*dstn = 0;
+		return -EPROTONOSUPPORT;
+	default:
+		*dstn = 0;
+		return -EPROTO;
+	}
+}
@@ -42,13 +42,27 @@
 # define NFS_TIMEOUT CONFIG_NFS_TIMEOUT
 #endif
 
+#ifndef CONFIG_NFS_READ_WINDOW
+# define NFS_READ_WINDOW 1
+#else
+# define NFS_READ_WINDOW CONFIG_NFS_READ_WINDOW
+#endif
+
 #define NFS_RPC_ERR	1
 #define NFS_RPC_DROP	124
 
 static int fs_mounted;
 static unsigned long rpc_id;
-static int nfs_offset = -1;
-static int nfs_len;
+static int nfs_offset = -1;	/* offset of the next READ to send */
+static int nfs_len;		/* size of each READ */
+static int nfs_eof_offset;	/* end of file, -1 while unknown */
+
+/* Outstanding READ requests, matched to their replies by RPC id */
+static struct nfs_read_slot {
+	unsigned long id;	/* 0 if the slot is free */
+	int offset;
+	int len;
+} nfs_read_slots[NFS_READ_WINDOW];
 static ulong nfs_timeout = NFS_TIMEOUT;
 
 static char dirfh[NFS_FHSIZE];	/* NFSv2 / NFSv3 file handle of directory */
@@ -386,6 +400,97 @@ static void nfs_read_req(int offset, int readlen)
 	rpc_req(PROG_NFS, NFS_READ, data, len);
 }
 
+static void nfs_read_send(struct nfs_read_slot *slot)
+{
+	nfs_read_req(slot->offset, slot->len);
+	slot->id = rpc_id;
+}
+
+/* Send READs for the following blocks until the window is full */
+static void nfs_read_fill(void)
+{
+	struct nfs_read_slot *slot;
+
+	for (slot = nfs_read_slots;
+	     slot < nfs_read_slots + NFS_READ_WINDOW; slot++) {
+		if (slot->id)
+			continue;
+		if (nfs_eof_offset >= 0 && nfs_offset >= nfs_eof_offset)
+			break;
+		slot->offset = nfs_offset;
+		slot->len = nfs_len;
+		nfs_offset += nfs_len;
+		nfs_read_send(slot);
+	}
+}
+
+static void nfs_read_start(void)
+{
+	memset(nfs_read_slots, 0, sizeof(nfs_read_slots));
+	nfs_offset = 0;
+	nfs_eof_offset = -1;
+	if (supported_nfs_versions & NFSV2_FLAG)
+		nfs_len = NFS_READ_SIZE;
+	else /* NFSV3_FLAG */
+		nfs_len = NFS3_READ_SIZE;
+
+	nfs_read_fill();
+}
+
+/* Send all outstanding READs again, with new RPC ids */
+static void nfs_read_resend(void)
+{
+	struct nfs_read_slot *slot;
+
+	for (slot = nfs_read_slots;
+	     slot < nfs_read_slots + NFS_READ_WINDOW; slot++)
+		if (slot->id)
+			nfs_read_send(slot);
+}
+
+static struct nfs_read_slot *nfs_read_lookup(unsigned long id)
+{
+	struct nfs_read_slot *slot;
+
+	for (slot = nfs_read_slots;
+	     slot < nfs_read_slots + NFS_READ_WINDOW; slot++)
+		if (slot->id && slot->id == id)
+			return slot;
+
+	return NULL;
+}
+
+/*
+ * Account for a READ reply of @rlen bytes to @slot and keep the window full.
+ * The rest of a short read is requested again, an empty one marks the end
+ * of the file. Returns true once the whole file has been received.
+ */
+static bool nfs_read_done(struct nfs_read_slot *slot, int rlen)
+{
+	if (!rlen) {
+		if (nfs_eof_offset < 0 || slot->offset < nfs_eof_offset)
+			nfs_eof_offset = slot->offset;
+		slot->id = 0;
+	} else if (rlen < slot->len &&
+		   (nfs_eof_offset < 0 ||
+		    slot->offset + rlen < nfs_eof_offset)) {
+		slot->offset += rlen;
+		slot->len -= rlen;
+		nfs_read_send(slot);
+	} else {
+		slot->id = 0;
+	}
+
+	nfs_read_fill();
+
+	for (slot = nfs_read_slots;
+	     slot < nfs_read_slots + NFS_READ_WINDOW; slot++)
+		if (slot->id)
+			return false;
+
+	return true;
+}
+
 /**************************************************************************
 RPC request dispatcher
 **************************************************************************/
@@ -416,7 +521,7 @@ static void nfs_send(void)
 		nfs_lookup_req(nfs_filename);
 		break;
 	case STATE_READ_REQ:
-		nfs_read_req(nfs_offset, nfs_len);
+		nfs_read_resend();
 		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req();
@@ -652,20 +757,31 @@ static int nfs_readlink_reply(uchar *pkt, unsigned len)
 	return 0;
 }
 
-static int nfs_read_reply(uchar *pkt, unsigned len)
+static int nfs_read_reply(uchar *pkt, unsigned len,
+			  struct nfs_read_slot **slotp)
 {
 	struct rpc_t rpc_pkt;
+	struct nfs_read_slot *slot;
 	int rlen;
 	uchar *data_ptr;
 
 	debug("%s\n", __func__);
 
-	memcpy(&rpc_pkt.u.data[0], pkt, sizeof(rpc_pkt.u.reply));
+	/*
+	 * Only the header is copied: a READ reply can be larger than
+	 * struct rpc_t, so the data is stored straight from the packet
+	 */
+	memcpy(&rpc_pkt.u.data[0], pkt,
+	       min_t(size_t, len, sizeof(rpc_pkt.u.reply)));
 
 	if (ntohl(rpc_pkt.u.reply.id) > rpc_id)
 		return -NFS_RPC_ERR;
-	else if (ntohl(rpc_pkt.u.reply.id) < rpc_id)
+
+	/* Replies may arrive in any order, or be stale after a resend */
+	slot = nfs_read_lookup(ntohl(rpc_pkt.u.reply.id));
+	if (!slot)
 		return -NFS_RPC_DROP;
+	*slotp = slot;
 
 	if (rpc_pkt.u.reply.rstatus  ||
 	    rpc_pkt.u.reply.verifier ||
@@ -678,10 +794,10 @@ static int nfs_read_reply(uchar *pkt, unsigned len)
 		return -ntohl(rpc_pkt.u.reply.data[0]);
 	}
 
-	if ((nfs_offset != 0) && !((nfs_offset) %
+	if ((slot->offset != 0) && !((slot->offset) %
 			(NFS_READ_SIZE / 2 * 10 * HASHES_PER_LINE)))
 		puts("\n\t ");
-	if (!(nfs_offset % ((NFS_READ_SIZE / 2) * 10)))
+	if (!(slot->offset % ((NFS_READ_SIZE / 2) * 10)))
 		putc('#');
 
 	if (supported_nfs_versions & NFSV2_FLAG) {
@@ -701,7 +817,11 @@ static int nfs_read_reply(uchar *pkt, unsigned len)
 			&(rpc_pkt.u.reply.data[4 + nfsv3_data_offset]);
 	}
 
-	if (store_block(data_ptr, nfs_offset, rlen))
+	data_ptr = pkt + (data_ptr - rpc_pkt.u.data);
+	if (rlen < 0 || rlen > slot->len || data_ptr + rlen > pkt + len)
+		return -9999;
+
+	if (store_block(data_ptr, slot->offset, rlen))
 			return -9999;
 
 	return rlen;
@@ -727,6 +847,7 @@ static void nfs_timeout_handler(void)
 static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			unsigned src, unsigned len)
 {
+	struct nfs_read_slot *slot;
 	int rlen;
 	int reply;
 
@@ -796,9 +917,7 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			nfs_send();
 		} else {
 			nfs_state = STATE_READ_REQ;
-			nfs_offset = 0;
-			nfs_len = NFS_READ_SIZE;
-			nfs_send();
+			nfs_read_start();
 		}
 		break;
 
@@ -821,22 +940,22 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		break;
 
 	case STATE_READ_REQ:
-		rlen = nfs_read_reply(pkt, len);
+		rlen = nfs_read_reply(pkt, len, &slot);
 		if (rlen == -NFS_RPC_DROP)
 			break;
 		net_set_timeout_handler(nfs_timeout, nfs_timeout_handler);
-		if (rlen > 0) {
-			nfs_offset += rlen;
-			nfs_send();
+		if (rlen >= 0) {
+			if (nfs_read_done(slot, rlen)) {
+				nfs_download_state = NETLOOP_SUCCESS;
+				nfs_state = STATE_UMOUNT_REQ;
+				nfs_send();
+			}
 		} else if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
 			/* symbolic link */
 			nfs_state = STATE_READLINK_REQ;
 			nfs_send();
 		} else {
-			if (!rlen)
-				nfs_download_state = NETLOOP_SUCCESS;
-			if (rlen < 0)
-				debug("NFS READ error (%d)\n", rlen);
+			debug("NFS READ error (%d)\n", rlen);
 			nfs_state = STATE_UMOUNT_REQ;
 			nfs_send();
 		}
@@ -42,6 +42,11 @@
  * case, most NFS servers are optimized for a power of 2.
  */
 #define NFS_READ_SIZE	1024	/* biggest power of two that fits Ether frame */
+#if defined(CONFIG_IP_DEFRAG) && CONFIG_NFS3_READ_SIZE > NFS_READ_SIZE
+#define NFS3_READ_SIZE	CONFIG_NFS3_READ_SIZE
+#else
+#define NFS3_READ_SIZE	NFS_READ_SIZE
+#endif
 #define NFS_MAX_ATTRS	26
 
 /* Values for Accept State flag on RPC answers (See: rfc1831) */
@@ -108,6 +108,8 @@ static int	tftp_put_final_block_sent;
 #define TFTP_BLOCK_SIZE		512
 /* sequence number is 16 bit */
 #define TFTP_SEQUENCE_SIZE	((ulong)(1<<16))
+/* Blocks within half the sequence space ahead of us are new, not resent */
+#define TFTP_WINDOWSIZE_MAX	(TFTP_SEQUENCE_SIZE / 2 - 1)
 
 #define DEFAULT_NAME_LEN	(8 + 4 + 1)
 static char default_filename[DEFAULT_NAME_LEN];
@@ -134,6 +136,18 @@ static char tftp_filename[MAX_LEN];
 static unsigned short tftp_block_size = TFTP_BLOCK_SIZE;
 static unsigned short tftp_block_size_option = TFTP_MTU_BLOCKSIZE;
 
+/*
+ * RFC 7440 windowsize: the server sends this many blocks before waiting for
+ * an ACK. We only ACK the last block of each window, or the last block
+ * received in order when a block goes missing.
+ */
+static unsigned short tftp_windowsize = 1;
+static unsigned short tftp_windowsize_option = CONFIG_TFTP_WINDOWSIZE;
+/* block number which completes the current window */
+static ulong	tftp_next_ack;
+/* last block we sent an extra ACK for, to send only one per block */
+static ulong	tftp_last_nack;
+
 #ifdef CONFIG_MCAST_TFTP
 #include <malloc.h>
 #define MTFTP_BITMAPSIZE	0x1000
@@ -211,6 +225,8 @@ static void new_transfer(void)
 	tftp_prev_block = 0;
 	tftp_block_wrap = 0;
 	tftp_block_wrap_offset = 0;
+	tftp_next_ack = tftp_windowsize;
+	tftp_last_nack = TFTP_SEQUENCE_SIZE;
 #ifdef CONFIG_CMD_TFTPPUT
 	tftp_put_final_block_sent = 0;
 #endif
@@ -372,6 +388,11 @@ static void tftp_send(void)
 		/* try for more effic. blk size */
 		pkt += sprintf((char *)pkt, "blksize%c%d%c",
 				0, tftp_block_size_option, 0);
+
+		/* try for more blocks per ACK */
+		if (tftp_state == STATE_SEND_RRQ && tftp_windowsize_option > 1)
+			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
+					0, tftp_windowsize_option, 0);
 #ifdef CONFIG_MCAST_TFTP
 		/* Check all preconditions before even trying the option */
 		if (!tftp_mcast_disabled) {
@@ -457,6 +478,32 @@ static void icmp_handler(unsigned type, unsigned code, unsigned dest,
 }
 #endif
 
+/*
+ * Handle a DATA block which is not the next one expected while using a
+ * window. The block is dropped and the last block received in order is
+ * ACKed again, once, so that the server resends the window from there:
+ * - an older block is a duplicate from a window the server resent, which
+ *   means that our ACK for it was probably lost
+ * - a newer block means that one went missing
+ */
+static void tftp_out_of_order(ulong block)
+{
+	ulong ahead = (block - tftp_cur_block) % TFTP_SEQUENCE_SIZE;
+
+	if (ahead == 0 || ahead >= TFTP_SEQUENCE_SIZE / 2)
+		debug("Duplicate block %lu, expected %lu\n", block,
+		      (tftp_cur_block + 1) % TFTP_SEQUENCE_SIZE);
+	else
+		debug("Out of order block %lu, expected %lu\n", block,
+		      (tftp_cur_block + 1) % TFTP_SEQUENCE_SIZE);
+	if (tftp_last_nack == tftp_cur_block)
+		return;
+
+	tftp_last_nack = tftp_cur_block;
+	tftp_next_ack = (tftp_cur_block + tftp_windowsize) % TFTP_SEQUENCE_SIZE;
+	tftp_send();	/* ACK the last block received in order */
+}
+
 static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			 unsigned src, unsigned len)
 {
@@ -540,6 +587,17 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 				debug("Blocksize ack: %s, %d\n",
 				      (char *)pkt + i + 8, tftp_block_size);
 			}
+			if (strcmp((char *)pkt + i, "windowsize") == 0) {
+				tftp_windowsize = (unsigned short)
+					simple_strtoul((char *)pkt + i + 11,
+						       NULL, 10);
+				/* The server may only lower the window */
+				if (!tftp_windowsize ||
+				    tftp_windowsize > tftp_windowsize_option)
+					tftp_windowsize = 1;
+				debug("Windowsize ack: %s, %d\n",
+				      (char *)pkt + i + 11, tftp_windowsize);
+			}
 #ifdef CONFIG_TFTP_TSIZE
 			if (strcmp((char *)pkt+i, "tsize") == 0) {
 				tftp_tsize = simple_strtoul((char *)pkt + i + 6,
@@ -568,6 +626,14 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		if (len < 2)
 			return;
 		len -= 2;
+
+		if (tftp_windowsize > 1 && tftp_state == STATE_DATA &&
+		    ntohs(*(__be16 *)pkt) !=
+		    (tftp_cur_block + 1) % TFTP_SEQUENCE_SIZE) {
+			tftp_out_of_order(ntohs(*(__be16 *)pkt));
+			break;
+		}
+
 		tftp_cur_block = ntohs(*(__be16 *)pkt);
 
 		update_block_number();
@@ -638,6 +704,13 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			}
 		}
 #endif
+		if (tftp_windowsize > 1 && len == tftp_block_size) {
+			/* Only ACK the last block of the window */
+			if (tftp_cur_block != tftp_next_ack)
+				break;
+			tftp_next_ack = (tftp_cur_block + tftp_windowsize) %
+					TFTP_SEQUENCE_SIZE;
+		}
 		tftp_send();
 
 #ifdef CONFIG_MCAST_TFTP
@@ -690,6 +763,10 @@ static void tftp_timeout_handler(void)
 	} else {
 		puts("T ");
 		net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
+		/* The server restarts the window after the block we ACK */
+		if (tftp_state == STATE_DATA)
+			tftp_next_ack = (tftp_cur_block + tftp_windowsize) %
+					TFTP_SEQUENCE_SIZE;
 		if (tftp_state != STATE_RECV_WRQ)
 			tftp_send();
 	}
@@ -710,6 +787,18 @@ void tftp_start(enum proto_t protocol)
 	if (ep != NULL)
 		tftp_block_size_option = simple_strtol(ep, NULL, 10);
 
+	ep = env_get("tftpwindowsize");
+	if (ep != NULL) {
+		long windowsize = simple_strtol(ep, NULL, 10);
+
+		if (windowsize < 1 || windowsize > TFTP_WINDOWSIZE_MAX) {
+			printf("TFTP windowsize (%ld) invalid, set to 1\n",
+			       windowsize);
+			windowsize = 1;
+		}
+		tftp_windowsize_option = windowsize;
+	}
+
 	ep = env_get("tftptimeout");
 	if (ep != NULL)
 		timeout_ms = simple_strtol(ep, NULL, 10);
@@ -731,8 +820,8 @@ void tftp_start(enum proto_t protocol)
 	}
 #endif
 
-	debug("TFTP blocksize = %i, timeout = %ld ms\n",
-	      tftp_block_size_option, timeout_ms);
+	debug("TFTP blocksize = %i, windowsize = %i, timeout = %ld ms\n",
+	      tftp_block_size_option, tftp_windowsize_option, timeout_ms);
 
 	tftp_remote_ip = net_server_ip;
 	if (!net_parse_bootfile(&tftp_remote_ip, tftp_filename, MAX_LEN)) {
@@ -824,8 +913,9 @@ void tftp_start(enum proto_t protocol)
 
 	/* zero out server ether in case the server ip has changed */
 	memset(net_server_ethaddr, 0, 6);
-	/* Revert tftp_block_size to dflt */
+	/* Revert tftp_block_size and tftp_windowsize to dflt */
 	tftp_block_size = TFTP_BLOCK_SIZE;
+	tftp_windowsize = 1;
 #ifdef CONFIG_MCAST_TFTP
 	mcast_cleanup();
 #endif
@@ -853,8 +943,9 @@ void tftp_start_server(void)
 	timeout_ms = TIMEOUT;
 	net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
 
-	/* Revert tftp_block_size to dflt */
+	/* Revert tftp_block_size and tftp_windowsize to dflt */
 	tftp_block_size = TFTP_BLOCK_SIZE;
+	tftp_windowsize = 1;
 	tftp_cur_block = 0;
 	tftp_our_port = WELL_KNOWN_PORT;
 
@@ -16,5 +16,10 @@ build_uboot() {
 	NUM_CPUS=$(grep -c processor /proc/cpuinfo)
 	echo ${OPTS}
 	make ${OPTS} sandbox_config
+	# Add any extra options given, one per line
+	if [ -n "$2" ]; then
+		echo "$2" >>${OUTPUT_DIR}/.config
+		make ${OPTS} olddefconfig
+	fi
 	make ${OPTS} -s -j${NUM_CPUS}
 }
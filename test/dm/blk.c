@@ -167,3 +167,52 @@ static int dm_test_blk_get_from_parent(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_blk_get_from_parent, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(BLOCK_CACHE)
+/* Test that sequential reads are read ahead into the block cache */
+static int dm_test_blk_cache(struct unit_test_state *uts)
+{
+	struct block_cache_stats stats, old;
+	struct blk_desc *dev_desc;
+	struct udevice *dev;
+	char buf[1024];
+
+	ut_assertok(uclass_get_device(UCLASS_MMC, 0, &dev));
+	ut_assertok(blk_get_device_by_str("mmc", "0", &dev_desc));
+	ut_assert(dev_desc->lba >= 6);
+
+	blkcache_stats(&old);
+	blkcache_configure(2, 16, 2);
+	blkcache_invalidate(dev_desc->if_type, dev_desc->devnum);
+
+	/* The first read is not sequential so nothing is read ahead */
+	ut_asserteq(1, blk_dread(dev_desc, 2, 1, buf));
+
+	/*
+	 * The second one reads blocks 3-5 with a multi-block read, which
+	 * sandbox fills with a test string
+	 */
+	memset(buf, '\0', sizeof(buf));
+	ut_asserteq(1, blk_dread(dev_desc, 3, 1, buf));
+	ut_assertok(strcmp(buf, "this is a test"));
+	ut_asserteq(1, blk_dread(dev_desc, 4, 1, buf));
+	ut_asserteq(1, blk_dread(dev_desc, 5, 1, buf));
+
+	/* Block 3 is still cached */
+	memset(buf, '\0', sizeof(buf));
+	ut_asserteq(1, blk_dread(dev_desc, 3, 1, buf));
+	ut_assertok(strcmp(buf, "this is a test"));
+
+	blkcache_stats(&stats);
+	ut_asserteq(3, stats.hits);
+	ut_asserteq(2, stats.misses);
+	ut_asserteq(2, stats.readahead);
+	ut_asserteq(4, stats.entries);
+
+	blkcache_configure(old.max_blocks_per_entry, old.max_entries,
+			   old.max_readahead);
+
+	return 0;
+}
+DM_TEST(dm_test_blk_cache, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+#endif
@@ -901,3 +901,105 @@ static int dm_test_inactive_child(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_inactive_child, DM_TESTF_SCAN_PDATA);
+
+/* Number of devices bound, and lookups timed, by dm_test_uclass_lookup() */
+#define LOOKUP_DEVICES	2000
+#define LOOKUP_COUNT	1000
+
+/* Test lookups in a large uclass, and compare them with walking the list */
+static int dm_test_uclass_lookup(struct unit_test_state *uts)
+{
+	struct dm_test_state *dms = uts->priv;
+	struct udevice *dev, *last, *found;
+	ulong start, by_seq, by_node, walk;
+	struct uclass *uc;
+	char name[20];
+	ofnode node;
+	int i;
+
+	/* Skip the behaviour in test_post_probe() */
+	dms->skip_post_probe = 1;
+
+	for (i = 0; i < LOOKUP_DEVICES; i++) {
+		ut_assertok(device_bind_ofnode(dms->root,
+					       DM_GET_DRIVER(test_drv),
+					       "lookup", 0, ofnode_null(),
+					       &dev));
+		snprintf(name, sizeof(name), "lookup%d", i);
+		ut_assertok(device_set_name(dev, name));
+	}
+	last = dev;
+
+	/* Give the last device a node and a sequence number */
+	node = ofnode_path("/a-test");
+	ut_assert(ofnode_valid(node));
+	dev_set_ofnode(last, node);
+	last->req_seq = 500;
+	ut_assertok(device_probe(last));
+	ut_asserteq(500, last->seq);
+
+	start = timer_get_us();
+	for (i = 0; i < LOOKUP_COUNT; i++)
+		ut_assertok(uclass_find_device_by_seq(UCLASS_TEST, 500, false,
+						      &found));
+	by_seq = timer_get_us() - start;
+	ut_asserteq_ptr(last, found);
+
+	start = timer_get_us();
+	for (i = 0; i < LOOKUP_COUNT; i++)
+		ut_assertok(uclass_find_device_by_ofnode(UCLASS_TEST, node,
+							 &found));
+	by_node = timer_get_us() - start;
+	ut_asserteq_ptr(last, found);
+
+	/* This is what each lookup used to cost */
+	ut_assertok(uclass_get(UCLASS_TEST, &uc));
+	start = timer_get_us();
+	for (i = 0; i < LOOKUP_COUNT; i++) {
+		found = NULL;
+		uclass_foreach_dev(dev, uc) {
+			if (dev->seq == 500) {
+				found = dev;
+				break;
+			}
+		}
+	}
+	walk = timer_get_us() - start;
+	ut_asserteq_ptr(last, found);
+
+	/* The timings are for information; they are too noisy to check */
+	printf("%d devices, %d lookups: seq %lu us, node %lu us, list walk %lu us\n",
+	       LOOKUP_DEVICES, LOOKUP_COUNT, by_seq, by_node, walk);
+
+	/* Names are found by prefix, so the first match in the list wins */
+	snprintf(name, sizeof(name), "lookup%d", LOOKUP_DEVICES - 1);
+	ut_assertok(uclass_find_device_by_name(UCLASS_TEST, name, &found));
+	ut_asserteq_ptr(last, found);
+	ut_assertok(uclass_find_device_by_name(UCLASS_TEST, "lookup", &found));
+	ut_asserteq_str("lookup0", found->name);
+	ut_assertok(device_set_name(last, "look"));
+	ut_assertok(uclass_find_device_by_name(UCLASS_TEST, "look", &found));
+	ut_asserteq_str("lookup0", found->name);
+	ut_asserteq(-ENODEV, uclass_find_device_by_name(UCLASS_TEST, "nothing",
+							&found));
+
+	/* Changing a key moves the device in the index */
+	dev_set_ofnode(last, ofnode_null());
+	ut_asserteq(-ENODEV, uclass_find_device_by_ofnode(UCLASS_TEST, node,
+							  &found));
+
+	ut_assertok(device_remove(last, DM_REMOVE_NORMAL));
+	ut_asserteq(-ENODEV, uclass_find_device_by_seq(UCLASS_TEST, 500, false,
+						       &found));
+
+	/* Unbinding removes the device from the index */
+	dev_set_ofnode(last, node);
+	ut_assertok(uclass_find_device_by_ofnode(UCLASS_TEST, node, &found));
+	ut_asserteq_ptr(last, found);
+	ut_assertok(device_unbind(last));
+	ut_asserteq(-ENODEV, uclass_find_device_by_ofnode(UCLASS_TEST, node,
+							  &found));
+
+	return 0;
+}
+DM_TEST(dm_test_uclass_lookup, 0);
@@ -585,3 +585,170 @@ static int dm_test_fdt_disable_enable_by_path(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_fdt_disable_enable_by_path, DM_TESTF_SCAN_PDATA |
 					    DM_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(OF_LIBFDT_CACHE)
+/* Test that cached phandle and path lookups follow changes to the tree */
+static int dm_test_fdt_lookup_cache(struct unit_test_state *uts)
+{
+	int size = fdt_totalsize(gd->fdt_blob) + 0x100;
+	int node, orig_node;
+	uint32_t phandle;
+	void *blob;
+
+	blob = malloc(size);
+	ut_assertnonnull(blob);
+	ut_assertok(fdt_open_into(gd->fdt_blob, blob, size));
+
+	node = fdt_path_offset(blob, "/base-gpios");
+	ut_assert(node >= 0);
+	phandle = fdt_get_phandle(blob, node);
+	ut_assert(phandle);
+	ut_asserteq(node, fdt_node_offset_by_phandle(blob, phandle));
+	ut_asserteq(node, fdt_path_offset(blob, "/base-gpios"));
+	orig_node = node;
+
+	/* Removing an earlier node moves this one */
+	ut_assertok(fdt_del_node(blob, fdt_path_offset(blob, "/backlight")));
+	ut_asserteq(-FDT_ERR_NOTFOUND, fdt_path_offset(blob, "/backlight"));
+	node = fdt_path_offset(blob, "/base-gpios");
+	ut_asserteq_str("base-gpios", fdt_get_name(blob, node, NULL));
+	ut_asserteq(node, fdt_node_offset_by_phandle(blob, phandle));
+
+	/* Each tree has its own cache */
+	ut_asserteq(orig_node, fdt_node_offset_by_phandle(gd->fdt_blob,
+							  phandle));
+	ut_asserteq(node, fdt_node_offset_by_phandle(blob, phandle));
+	ut_asserteq(orig_node, fdt_path_offset(gd->fdt_blob, "/base-gpios"));
+	ut_asserteq(node, fdt_path_offset(blob, "/base-gpios"));
+
+	/* A node which was not found can appear without a change in size */
+	ut_asserteq(-FDT_ERR_NOTFOUND, fdt_path_offset(blob, "/base-gpiox"));
+	ut_assertok(fdt_set_name(blob, node, "base-gpiox"));
+	ut_asserteq(node, fdt_path_offset(blob, "/base-gpiox"));
+	ut_asserteq(-FDT_ERR_NOTFOUND, fdt_path_offset(blob, "/base-gpios"));
+	ut_assertok(fdt_set_name(blob, node, "base-gpios"));
+
+	/* Changing the phandle in place does not change the size */
+	ut_assertok(fdt_setprop_inplace_u32(blob, node, "phandle", 0x1234));
+	ut_asserteq(-FDT_ERR_NOTFOUND, fdt_node_offset_by_phandle(blob,
+								   phandle));
+	ut_asserteq(node, fdt_node_offset_by_phandle(blob, 0x1234));
+
+	fdt_cache_invalidate(blob);
+	free(blob);
+
+	return 0;
+}
+DM_TEST(dm_test_fdt_lookup_cache, 0);
+#endif
+
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+/* Most devices that dm_test_lazy_bind() expects in UCLASS_TEST_FDT */
+#define LAZY_MAX_DEVS	16
+
+/* Find a child of the root by name, without binding anything */
+static struct udevice *lazy_find_root_child(const char *name)
+{
+	struct udevice *dev;
+
+	list_for_each_entry(dev, &gd->dm_root->child_head, sibling_node) {
+		if (!strcmp(dev->name, name))
+			return dev;
+	}
+
+	return NULL;
+}
+
+/* Probe the devices in a uclass, recording their nodes and sequence numbers */
+static int lazy_get_devices(struct unit_test_state *uts, enum uclass_id id,
+			    ofnode nodes[], int seqs[], int *countp)
+{
+	struct udevice *dev;
+	struct uclass *uc;
+	int count = 0;
+
+	ut_assertok(uclass_get(id, &uc));
+	uclass_foreach_dev(dev, uc) {
+		ut_assert(count < LAZY_MAX_DEVS);
+		ut_assertok(device_probe(dev));
+		nodes[count] = dev_ofnode(dev);
+		seqs[count] = dev->seq;
+		count++;
+	}
+	*countp = count;
+
+	return 0;
+}
+
+/* Test that nodes are bound when first used, in the same order as otherwise */
+static int dm_test_lazy_bind(struct unit_test_state *uts)
+{
+	ofnode eager_nodes[LAZY_MAX_DEVS], lazy_nodes[LAZY_MAX_DEVS];
+	int eager_seqs[LAZY_MAX_DEVS], lazy_seqs[LAZY_MAX_DEVS];
+	int eager_count, lazy_count;
+	struct udevice *dev, *bus;
+	struct uclass *uc;
+	int id, i;
+
+	/* Bind every node straight away, as other scans do */
+	ut_assertok(dm_scan_fdt(gd->fdt_blob, false));
+	ut_assertnonnull(lazy_find_root_child("cpu-test1"));
+	ut_assertok(uclass_get_device(UCLASS_TEST_BUS, 0, &bus));
+	ut_assertok(lazy_get_devices(uts, UCLASS_TEST_FDT, eager_nodes,
+				     eager_seqs, &eager_count));
+	ut_assert(eager_count > 0);
+	ut_assertnonnull(gd->dm_compat);
+
+	/* dm_uninit() also frees the table of compatible strings */
+	ut_assertok(dm_uninit());
+	ut_assertnull(gd->dm_compat);
+	ut_assertnull(gd->dm_pending);
+	for (id = 0; id < UCLASS_COUNT; id++) {
+		uc = uclass_find(id);
+		if (uc)
+			ut_assertok(uclass_destroy(uc));
+	}
+	gd->dm_root = NULL;
+	ut_assertok(dm_init(of_live_active()));
+
+	/* Now only record the nodes, as dm_init_and_scan() does */
+	lists_defer_bind(true);
+	ut_assertok(dm_scan_fdt(gd->fdt_blob, false));
+	lists_defer_bind(false);
+	ut_assertnonnull(gd->dm_pending);
+
+	/* The CPUs are bound when their uclass is first used */
+	ut_assertnull(lazy_find_root_child("cpu-test1"));
+	ut_assertok(uclass_get(UCLASS_CPU, &uc));
+	dev = lazy_find_root_child("cpu-test1");
+	ut_assertnonnull(dev);
+	ut_asserteq_ptr(uc, dev->uclass);
+
+	/* Looking up a PHY's node binds it, and the other PHYs */
+	ut_assertnull(lazy_find_root_child("gen_phy@0"));
+	ut_assertnull(lazy_find_root_child("gen_phy@1"));
+	ut_assertok(device_find_global_by_ofnode(ofnode_path("/gen_phy@0"),
+						 &dev));
+	ut_asserteq_str("gen_phy@0", dev->name);
+	ut_assertnonnull(lazy_find_root_child("gen_phy@1"));
+
+	/*
+	 * The test bus binds its children, which are test devices, straight
+	 * away when probed. That binds the recorded test devices first, so
+	 * they are in the same order and get the same sequence numbers.
+	 */
+	ut_assertnull(lazy_find_root_child("a-test"));
+	ut_assertok(uclass_get_device(UCLASS_TEST_BUS, 0, &bus));
+	ut_assertnonnull(lazy_find_root_child("a-test"));
+	ut_assertok(lazy_get_devices(uts, UCLASS_TEST_FDT, lazy_nodes,
+				     lazy_seqs, &lazy_count));
+	ut_asserteq(eager_count, lazy_count);
+	for (i = 0; i < eager_count; i++) {
+		ut_assert(ofnode_equal(eager_nodes[i], lazy_nodes[i]));
+		ut_asserteq(eager_seqs[i], lazy_seqs[i]);
+	}
+
+	return 0;
+}
+DM_TEST(dm_test_lazy_bind, 0);
+#endif
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the hash table used to hold the environment
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <search.h>
+#include <test/env.h>
+#include <test/ut.h>
+
+#define HTAB_TEST_KEY	"provisioned_variable_%05d"
+
+static int htab_test_fill(struct unit_test_state *uts,
+			  struct hsearch_data *htab, int count)
+{
+	char key[32], value[32];
+	ENTRY e, *ep;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		snprintf(key, sizeof(key), HTAB_TEST_KEY, i);
+		snprintf(value, sizeof(value), "value%d", i);
+		e.key = key;
+		e.data = value;
+		ut_assert(hsearch_r(e, ENTER, &ep, htab, 0));
+		ut_assertnonnull(ep);
+	}
+
+	return 0;
+}
+
+/* Test that the table grows, and that deleted entries are handled */
+static int env_test_htab_grow(struct unit_test_state *uts)
+{
+	struct hsearch_data htab = { .table = NULL };
+	char key[32], value[32], *res;
+	ENTRY e, *ep;
+	int i, idx;
+	size_t len;
+
+	ut_assert(hcreate_r(16, &htab));
+	ut_assertok(htab_test_fill(uts, &htab, 100));
+	ut_asserteq(100, htab.filled);
+	ut_assert(htab.size > 100);
+
+	/* Delete the odd ones, then check what is left */
+	for (i = 1; i < 100; i += 2) {
+		snprintf(key, sizeof(key), HTAB_TEST_KEY, i);
+		ut_assert(hdelete_r(key, &htab, 0));
+	}
+	ut_asserteq(50, htab.filled);
+	for (i = 0; i < 100; i++) {
+		snprintf(key, sizeof(key), HTAB_TEST_KEY, i);
+		e.key = key;
+		e.data = NULL;
+		hsearch_r(e, FIND, &ep, &htab, 0);
+		if (i & 1) {
+			ut_assertnull(ep);
+		} else {
+			ut_assertnonnull(ep);
+		}
+	}
+
+	/* Export is in key order, without the deleted entries */
+	res = NULL;
+	ut_assert(hexport_r(&htab, '\n', 0, &res, 0, 0, NULL) > 0);
+	ut_assertok(strncmp(res, "provisioned_variable_00000=value0\n"
+			    "provisioned_variable_00002=value2\n", 68));
+	for (i = 0, len = 0; i < 100; i += 2) {
+		snprintf(key, sizeof(key), HTAB_TEST_KEY, i);
+		snprintf(value, sizeof(value), "value%d", i);
+		len += strlen(key) + strlen(value) + 2;
+	}
+	ut_asserteq(len, strlen(res));
+	free(res);
+
+	/* Matches come in key order too */
+	idx = hmatch_r("provisioned_variable_0001", 0, &ep, &htab);
+	ut_assert(idx);
+	ut_asserteq_str("provisioned_variable_00010", ep->key);
+	for (i = 12; i < 20; i += 2) {
+		idx = hmatch_r("provisioned_variable_0001", idx, &ep, &htab);
+		ut_assert(idx);
+		snprintf(key, sizeof(key), HTAB_TEST_KEY, i);
+		ut_asserteq_str(key, ep->key);
+	}
+	ut_asserteq(0, hmatch_r("provisioned_variable_0001", idx, &ep,
+				&htab));
+
+	/* Enumerating can carry on from the position of a key */
+	idx = hmatch_r("provisioned_variable_00018", 0, &ep, &htab);
+	ut_assert(idx);
+	ut_asserteq_str("provisioned_variable_00018", ep->key);
+	ut_assert(hmatch_r("", idx, &ep, &htab));
+	ut_asserteq_str("provisioned_variable_00020", ep->key);
+
+	hdestroy_r(&htab);
+
+	return 0;
+}
+ENV_TEST(env_test_htab_grow, 0);
+
+/* Time adding, finding, exporting and deleting many variables */
+static int env_test_htab_speed(struct unit_test_state *uts)
+{
+	struct hsearch_data htab;
+	ulong start, add, find, export, del;
+	char key[32], *res;
+	ENTRY e, *ep;
+	int count, i;
+
+	for (count = 500; count <= 4000; count *= 2) {
+		memset(&htab, '\0', sizeof(htab));
+		ut_assert(hcreate_r(64, &htab));
+
+		start = timer_get_us();
+		ut_assertok(htab_test_fill(uts, &htab, count));
+		add = timer_get_us() - start;
+
+		start = timer_get_us();
+		for (i = 0; i < count; i++) {
+			snprintf(key, sizeof(key), HTAB_TEST_KEY, i);
+			e.key = key;
+			e.data = NULL;
+			hsearch_r(e, FIND, &ep, &htab, 0);
+			ut_assertnonnull(ep);
+		}
+		find = timer_get_us() - start;
+
+		res = NULL;
+		start = timer_get_us();
+		ut_assert(hexport_r(&htab, '\0', 0, &res, 0, 0, NULL) > 0);
+		export = timer_get_us() - start;
+		free(res);
+
+		start = timer_get_us();
+		for (i = 0; i < count; i++) {
+			snprintf(key, sizeof(key), HTAB_TEST_KEY, i);
+			ut_assert(hdelete_r(key, &htab, 0));
+		}
+		del = timer_get_us() - start;
+		ut_asserteq(0, htab.filled);
+
+		printf("%d variables: add %lu us, find %lu us, export %lu us, delete %lu us\n",
+		       count, add, find, export, del);
+		hdestroy_r(&htab);
+	}
+
+	return 0;
+}
+ENV_TEST(env_test_htab_speed, 0);
@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for tracking changes to the environment between saves
+ */
+
+#include <common.h>
+#include <environment.h>
+#include <malloc.h>
+#include <test/env.h>
+#include <test/ut.h>
+
+static int env_test_changed(struct unit_test_state *uts)
+{
+	ut_assertok(env_set("test_changed", "1"));
+	env_set_stored(true);
+	ut_asserteq(false, env_changed());
+
+	/* Setting a variable to the value it has is not a change */
+	ut_assertok(env_set("test_changed", "1"));
+	ut_asserteq(false, env_changed());
+
+	ut_assertok(env_set("test_changed", "2"));
+	ut_asserteq(true, env_changed());
+
+	env_set_stored(true);
+	ut_assertok(env_set("test_changed", NULL));
+	ut_asserteq(true, env_changed());
+
+	env_set_stored(true);
+	ut_assertok(env_set("test_changed", "3"));
+	ut_asserteq(true, env_changed());
+	ut_assertok(env_set("test_changed", NULL));
+
+	/* The default environment is never taken to be stored */
+	env_set_stored(false);
+	ut_asserteq(true, env_changed());
+
+	return 0;
+}
+ENV_TEST(env_test_changed, 0);
+
+/* Size of each unit of the test storage, which does not divide ENV_SIZE */
+#define ENV_TEST_UNIT	0x300
+
+/* Storage in memory which counts what is written to it */
+struct env_test_store {
+	char data[CONFIG_ENV_SIZE];
+	int runs;
+	int units;
+	bool read_fails;
+};
+
+static int env_test_read(void *priv, uint unit, uint count, uint len,
+			 void *buf)
+{
+	struct env_test_store *store = priv;
+
+	if (store->read_fails)
+		return -EIO;
+	memcpy(buf, store->data + unit * ENV_TEST_UNIT, len);
+
+	return 0;
+}
+
+static int env_test_write(void *priv, uint unit, uint count, uint len,
+			  const void *buf)
+{
+	struct env_test_store *store = priv;
+	uint pos = unit * ENV_TEST_UNIT;
+
+	if (len != min_t(uint, count * ENV_TEST_UNIT, CONFIG_ENV_SIZE - pos))
+		return -EINVAL;
+	memcpy(store->data + pos, buf, len);
+	store->runs++;
+	store->units += count;
+
+	return 0;
+}
+
+static const struct env_write_ops env_test_ops = {
+	.read	= env_test_read,
+	.write	= env_test_write,
+};
+
+/* Export the environment and save it to @store, returning units written */
+static int env_test_save(struct unit_test_state *uts,
+			 struct env_test_store *store, env_t *env)
+{
+	int ret;
+
+	store->runs = 0;
+	store->units = 0;
+	ut_assertok(env_export(env));
+	ret = env_write_changed(&env_test_ops, store, env, CONFIG_ENV_SIZE,
+				ENV_TEST_UNIT);
+	ut_asserteq(store->units, ret);
+	ut_assertok(memcmp(env, store->data, CONFIG_ENV_SIZE));
+
+	return ret;
+}
+
+/* Test that saving twice only writes the units which changed */
+static int env_test_write_changed(struct unit_test_state *uts)
+{
+	uint units = DIV_ROUND_UP(CONFIG_ENV_SIZE, ENV_TEST_UNIT);
+	struct env_test_store *store;
+	uint var_unit;
+	env_t *env;
+	char *ptr;
+
+	store = malloc(sizeof(*store));
+	env = malloc(sizeof(*env));
+	ut_assertnonnull(store);
+	ut_assertnonnull(env);
+	memset(store, '\xff', sizeof(*store));
+	store->read_fails = false;
+
+	/* Everything is written the first time */
+	ut_assertok(env_set("test_write_changed", "1"));
+	ut_asserteq(units, env_test_save(uts, store, env));
+	ut_asserteq(1, store->runs);
+
+	/* Nothing is written if nothing changed */
+	ut_asserteq(0, env_test_save(uts, store, env));
+	ut_asserteq(0, store->runs);
+
+	/*
+	 * Changing one character only changes the unit holding it and the
+	 * first unit, which holds the CRC
+	 */
+	ut_assertok(env_set("test_write_changed", "2"));
+	for (ptr = (char *)env->data; *ptr; ptr += strlen(ptr) + 1) {
+		if (!strcmp(ptr, "test_write_changed=1"))
+			break;
+	}
+	ut_assert(*ptr);
+	var_unit = (ptr + strlen(ptr) - 1 - (char *)env) / ENV_TEST_UNIT;
+	ut_asserteq(var_unit ? 2 : 1, env_test_save(uts, store, env));
+	ut_asserteq(var_unit > 1 ? 2 : 1, store->runs);
+
+	ut_asserteq(0, env_test_save(uts, store, env));
+
+	/* Everything is written if the storage cannot be read */
+	store->read_fails = true;
+	ut_asserteq(units, env_test_save(uts, store, env));
+	ut_asserteq(1, store->runs);
+
+	ut_assertok(env_set("test_write_changed", NULL));
+	free(env);
+	free(store);
+
+	return 0;
+}
+ENV_TEST(env_test_write_changed, 0);
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the init function timings recorded by bootstage
+ */
+
+#include <common.h>
+#include <bootstage.h>
+#include <fdtdec.h>
+#include <malloc.h>
+#include <dm/test.h>
+#include <linux/libfdt.h>
+#include <test/ut.h>
+
+/* Test that the timings are added to the OS device tree, slowest first */
+static int lib_test_bootstage_initcalls_fdt(struct unit_test_state *uts)
+{
+	struct fdt_header *old_fdt = working_fdt;
+	const int size = 0x8000;
+	char name[12];
+	u32 accum, prev = ~0;
+	const char *str;
+	int node, count, ret;
+	void *blob;
+
+	blob = malloc(size);
+	ut_assertnonnull(blob);
+	ut_assertok(fdt_create_empty_tree(blob, size));
+	working_fdt = blob;
+	ret = bootstage_fdt_add_report();
+	working_fdt = old_fdt;
+	ut_assertok(ret);
+
+	node = fdt_path_offset(blob, "/chosen/bootstage-initcalls");
+	ut_assert(node >= 0);
+
+	count = 0;
+	for (node = fdt_first_subnode(blob, node); node >= 0;
+	     node = fdt_next_subnode(blob, node), count++) {
+		snprintf(name, sizeof(name), "%d", count);
+		ut_asserteq_str(name, fdt_get_name(blob, node, NULL));
+
+		str = fdt_getprop(blob, node, "name", NULL);
+		ut_assertnonnull(str);
+		ut_assertok(strncmp("initcall 0x", str, 11));
+
+		accum = fdtdec_get_uint(blob, node, "accum", ~0);
+		ut_assert(accum <= prev);
+		prev = accum;
+	}
+
+	/* Sandbox runs far more than one init function once bootstage is up */
+	ut_assert(count > 1);
+	ut_assert(count <= CONFIG_BOOTSTAGE_INITCALL_COUNT);
+	free(blob);
+
+	return 0;
+}
+DM_TEST(lib_test_bootstage_initcalls_fdt, 0);
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the table-driven CRC32 and CRC32C implementations
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <dm/test.h>
+#include <test/ut.h>
+#include <u-boot/crc.h>
+
+#define CRC_BENCH_SIZE	(1 << 20)
+#define CRC_BENCH_LOOPS	16
+
+/* One bit at a time, as a reference for the table-driven versions */
+static uint32_t crc_bitwise(uint32_t crc, const u8 *p, int len, uint32_t poly)
+{
+	int i;
+
+	while (len--) {
+		crc ^= *p++;
+		for (i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ ((crc & 1) ? poly : 0);
+	}
+
+	return crc;
+}
+
+/* Check known values and every alignment/length pair against the reference */
+static int lib_test_crc32(struct unit_test_state *uts)
+{
+	const char *check = "123456789";
+	u8 buf[80];
+	int start, len;
+
+	ut_asserteq(0xcbf43926, crc32(0, (const u8 *)check, 9));
+	ut_asserteq(0, crc32(0, NULL, 0));
+
+	for (start = 0; start < sizeof(buf); start++)
+		buf[start] = start * 37 + 11;
+
+	for (start = 0; start < 8; start++) {
+		for (len = 0; len < sizeof(buf) - start; len++) {
+			ut_asserteq(crc_bitwise(0x12345678, buf + start, len,
+						0xedb88320),
+				    crc32_no_comp(0x12345678, buf + start,
+						  len));
+		}
+	}
+
+	return 0;
+}
+DM_TEST(lib_test_crc32, 0);
+
+#ifdef CONFIG_CRC32C
+static int lib_test_crc32c(struct unit_test_state *uts)
+{
+	const char *check = "123456789";
+	uint32_t table[256];
+	u8 buf[80];
+	int start, len;
+
+	crc32c_init(table, 0x82F63B78);
+	ut_asserteq(0xe3069283, ~crc32c_cal(~0, check, 9, table));
+
+	for (start = 0; start < sizeof(buf); start++)
+		buf[start] = start * 37 + 11;
+
+	for (start = 0; start < 8; start++) {
+		for (len = 0; len < sizeof(buf) - start; len++) {
+			ut_asserteq(crc_bitwise(~0, buf + start, len,
+						0x82F63B78),
+				    crc32c_cal(~0, (const char *)buf + start,
+					       len, table));
+		}
+	}
+
+	return 0;
+}
+DM_TEST(lib_test_crc32c, 0);
+#endif
+
+/* Report CRC32 throughput on a large buffer */
+static int lib_test_crc32_bench(struct unit_test_state *uts)
+{
+	ulong start, us;
+	uint32_t crc = 0;
+	u8 *buf;
+	int i;
+
+	buf = malloc(CRC_BENCH_SIZE);
+	ut_assertnonnull(buf);
+	for (i = 0; i < CRC_BENCH_SIZE; i++)
+		buf[i] = i ^ (i >> 8);
+
+	start = timer_get_us();
+	for (i = 0; i < CRC_BENCH_LOOPS; i++)
+		crc = crc32(crc, buf, CRC_BENCH_SIZE);
+	us = timer_get_us() - start;
+	free(buf);
+
+	printf("crc32: %d MiB in %lu us", CRC_BENCH_LOOPS, us);
+	if (us)
+		printf(", %lu MiB/s", CRC_BENCH_LOOPS * 1000000UL / us);
+	printf("\n");
+
+	return 0;
+}
+DM_TEST(lib_test_crc32_bench, 0);
@@ -216,6 +216,204 @@ static int fdt_overlay_stacked(struct unit_test_state *uts)
 }
 OVERLAY_TEST(fdt_overlay_stacked, 0);
 
+/* Get a packed copy of @fdt, which can be compared with another one */
+static void *ut_fdt_pack_copy(const void *fdt, int size)
+{
+	void *copy;
+
+	copy = malloc(size);
+	if (!copy)
+		return NULL;
+	if (fdt_open_into(fdt, copy, size) || fdt_pack(copy)) {
+		free(copy);
+		return NULL;
+	}
+
+	return copy;
+}
+
+static int fdt_overlay_apply_list_same(struct unit_test_state *uts)
+{
+	void *fdt_base = &__dtb_test_fdt_base_begin;
+	void *fdts[] = {
+		&__dtb_test_fdt_overlay_begin,
+		&__dtb_test_fdt_overlay_stacked_begin,
+	};
+	void *fdt, *expect;
+	int i;
+
+	/* The overlays are damaged, so work on copies */
+	fdt = malloc(FDT_COPY_SIZE);
+	ut_assertnonnull(fdt);
+	ut_assertok(fdt_open_into(fdt_base, fdt, FDT_COPY_SIZE));
+	for (i = 0; i < ARRAY_SIZE(fdts); i++) {
+		fdts[i] = ut_fdt_pack_copy(fdts[i], FDT_COPY_SIZE);
+		ut_assertnonnull(fdts[i]);
+	}
+
+	ut_assertok(fdt_overlay_apply_list(fdt, fdts, ARRAY_SIZE(fdts)));
+	for (i = 0; i < ARRAY_SIZE(fdts); i++) {
+		ut_asserteq(-FDT_ERR_BADMAGIC, fdt_check_header(fdts[i]));
+		free(fdts[i]);
+	}
+
+	/* This should give the same tree as applying them one by one */
+	expect = ut_fdt_pack_copy(uts->priv, FDT_COPY_SIZE);
+	ut_assertnonnull(expect);
+	ut_assertok(fdt_pack(fdt));
+	ut_asserteq(fdt_totalsize(expect), fdt_totalsize(fdt));
+	ut_assertok(memcmp(expect, fdt, fdt_totalsize(fdt)));
+	free(expect);
+	free(fdt);
+
+	return CMD_RET_SUCCESS;
+}
+OVERLAY_TEST(fdt_overlay_apply_list_same, 0);
+
+#define SPEED_NODES	1000
+#define SPEED_OVERLAYS	16
+#define SPEED_SIZE	SZ_256K
+
+/* Create a base tree with SPEED_NODES nodes, each with a phandle and label */
+static int ut_fdt_speed_base(struct unit_test_state *uts, void *fdt)
+{
+	char name[32], path[32];
+	int soc, syms, node, i;
+
+	ut_assertok(fdt_create_empty_tree(fdt, SPEED_SIZE));
+	soc = fdt_add_subnode(fdt, 0, "soc");
+	ut_assert(soc >= 0);
+	for (i = SPEED_NODES - 1; i >= 0; i--) {
+		snprintf(name, sizeof(name), "dev@%x", i);
+		node = fdt_add_subnode(fdt, soc, name);
+		ut_assert(node >= 0);
+		ut_assertok(fdt_setprop_u32(fdt, node, "phandle", i + 1));
+		ut_assertok(fdt_setprop_string(fdt, node, "status",
+					       "disabled"));
+	}
+
+	syms = fdt_add_subnode(fdt, 0, "__symbols__");
+	ut_assert(syms >= 0);
+	for (i = 0; i < SPEED_NODES; i++) {
+		snprintf(name, sizeof(name), "dev%d", i);
+		snprintf(path, sizeof(path), "/soc/dev@%x", i);
+		ut_assertok(fdt_setprop_string(fdt, syms, name, path));
+	}
+
+	return 0;
+}
+
+/*
+ * Create overlay @n, which enables a node of the base tree by label and adds
+ * a node with a local phandle, which refers to the node added by the
+ * previous overlay
+ */
+static int ut_fdt_speed_overlay(struct unit_test_state *uts, void *fdt,
+				int n)
+{
+	char name[32], path[64];
+	int frag, ovl, node;
+
+	ut_assertok(fdt_create_empty_tree(fdt, FDT_COPY_SIZE));
+	frag = fdt_add_subnode(fdt, 0, "fragment@0");
+	ut_assert(frag >= 0);
+	ut_assertok(fdt_setprop_u32(fdt, frag, "target", 0xffffffff));
+	ovl = fdt_add_subnode(fdt, frag, "__overlay__");
+	ut_assert(ovl >= 0);
+	ut_assertok(fdt_setprop_string(fdt, ovl, "status", "okay"));
+	snprintf(name, sizeof(name), "new-node-%d", n);
+	node = fdt_add_subnode(fdt, ovl, name);
+	ut_assert(node >= 0);
+	ut_assertok(fdt_setprop_u32(fdt, node, "phandle", 1));
+	ut_assertok(fdt_setprop_u32(fdt, node, "self", 1));
+	ut_assertok(fdt_setprop_u32(fdt, node, "prev", 0xffffffff));
+
+	node = fdt_add_subnode(fdt, 0, "__symbols__");
+	ut_assert(node >= 0);
+	snprintf(name, sizeof(name), "new%d", n);
+	snprintf(path, sizeof(path), "/fragment@0/__overlay__/new-node-%d", n);
+	ut_assertok(fdt_setprop_string(fdt, node, name, path));
+
+	node = fdt_add_subnode(fdt, 0, "__fixups__");
+	ut_assert(node >= 0);
+	snprintf(name, sizeof(name), "dev%d", n * SPEED_NODES / SPEED_OVERLAYS);
+	ut_assertok(fdt_setprop_string(fdt, node, name,
+				       "/fragment@0:target:0"));
+	if (n)
+		snprintf(name, sizeof(name), "new%d", n - 1);
+	else
+		strcpy(name, "dev1");
+	snprintf(path, sizeof(path), "/fragment@0/__overlay__/new-node-%d:prev:0",
+		 n);
+	ut_assertok(fdt_setprop_string(fdt, node, name, path));
+
+	node = fdt_add_subnode(fdt, 0, "__local_fixups__");
+	ut_assert(node >= 0);
+	node = fdt_add_subnode(fdt, node, "fragment@0");
+	ut_assert(node >= 0);
+	node = fdt_add_subnode(fdt, node, "__overlay__");
+	ut_assert(node >= 0);
+	snprintf(name, sizeof(name), "new-node-%d", n);
+	node = fdt_add_subnode(fdt, node, name);
+	ut_assert(node >= 0);
+	ut_assertok(fdt_setprop_u32(fdt, node, "self", 0));
+
+	return 0;
+}
+
+/* Compare applying a set of overlays one by one and in one go */
+static int fdt_overlay_apply_list_speed(struct unit_test_state *uts)
+{
+	void *fdts[SPEED_OVERLAYS];
+	void *base, *fdt, *expect;
+	ulong start, one, list;
+	int i;
+
+	base = malloc(SPEED_SIZE);
+	ut_assertnonnull(base);
+	ut_assertok(ut_fdt_speed_base(uts, base));
+	fdt = malloc(SPEED_SIZE);
+	ut_assertnonnull(fdt);
+	expect = malloc(SPEED_SIZE);
+	ut_assertnonnull(expect);
+	for (i = 0; i < SPEED_OVERLAYS; i++) {
+		fdts[i] = malloc(FDT_COPY_SIZE);
+		ut_assertnonnull(fdts[i]);
+	}
+
+	for (i = 0; i < SPEED_OVERLAYS; i++)
+		ut_assertok(ut_fdt_speed_overlay(uts, fdts[i], i));
+	ut_assertok(fdt_open_into(base, expect, SPEED_SIZE));
+	start = timer_get_us();
+	for (i = 0; i < SPEED_OVERLAYS; i++)
+		ut_assertok(fdt_overlay_apply(expect, fdts[i]));
+	one = timer_get_us() - start;
+
+	for (i = 0; i < SPEED_OVERLAYS; i++)
+		ut_assertok(ut_fdt_speed_overlay(uts, fdts[i], i));
+	ut_assertok(fdt_open_into(base, fdt, SPEED_SIZE));
+	start = timer_get_us();
+	ut_assertok(fdt_overlay_apply_list(fdt, fdts, SPEED_OVERLAYS));
+	list = timer_get_us() - start;
+
+	printf("%d nodes, %d overlays: one by one %lu us, list %lu us\n",
+	       SPEED_NODES, SPEED_OVERLAYS, one, list);
+
+	ut_assertok(fdt_pack(expect));
+	ut_assertok(fdt_pack(fdt));
+	ut_asserteq(fdt_totalsize(expect), fdt_totalsize(fdt));
+	ut_assertok(memcmp(expect, fdt, fdt_totalsize(fdt)));
+
+	for (i = 0; i < SPEED_OVERLAYS; i++)
+		free(fdts[i]);
+	free(expect);
+	free(fdt);
+	free(base);
+
+	return CMD_RET_SUCCESS;
+}
+OVERLAY_TEST(fdt_overlay_apply_list_speed, 0);
+
 int do_ut_overlay(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	struct unit_test *tests = ll_entry_start(struct unit_test,
@@ -0,0 +1,50 @@
+# SPDX-License-Identifier: GPL-2.0+
+# Copyright (c) 2018, Google Inc.
+
+"""
+Test the 'bootstage initcalls' command, which lists the time taken by each
+init function with the slowest first.
+"""
+
+import pytest
+import re
+
+@pytest.mark.buildconfigspec('cmd_bootstage')
+@pytest.mark.buildconfigspec('bootstage_initcalls')
+def test_bootstage_initcalls(u_boot_console):
+    """Test that the init function timings are sorted and totalled, and that
+    overflowing the table is reported."""
+    max_calls = int(u_boot_console.config.buildconfig.get(
+        'config_bootstage_initcall_count'))
+
+    output = u_boot_console.run_command('bootstage initcalls')
+    lines = iter(output.replace('\r', '').splitlines())
+
+    m = re.match(r'Init function time in microseconds \((\d+) calls\):$',
+                 lines.next())
+    assert m
+    count = int(m.group(1))
+    assert 0 < count <= max_calls
+    assert lines.next().split() == ['Elapsed', 'Function']
+
+    times = []
+    for i in range(count):
+        m = re.match(r' *([\d,]+)  initcall 0x[0-9a-f]+$', lines.next())
+        assert m
+        times.append(int(m.group(1).replace(',', '')))
+    assert times == sorted(times, reverse=True)
+
+    m = re.match(r' *([\d,]+)  total$', lines.next())
+    assert m
+    assert int(m.group(1).replace(',', '')) == sum(times)
+
+    # sandbox_flattree uses a small table so that this is tested
+    overflow = next(lines, None)
+    if overflow is None:
+        return
+    m = re.match(r'Overflowed init function table by (\d+) entries$', overflow)
+    assert m
+    assert int(m.group(1)) > 0
+    assert count == max_calls
+    assert (lines.next() ==
+            'Please increase CONFIG_BOOTSTAGE_INITCALL_COUNT')
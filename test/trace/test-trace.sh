@@ -6,6 +6,7 @@
 # Simple test script for tracing with sandbox
 
 TRACE_OPT="FTRACE=1"
+TRACE_CONFIG="CONFIG_CMD_TRACE=y"
 
 BASE="$(dirname $0)/.."
 . $BASE/common.sh
@@ -23,6 +24,9 @@ trace resume
 hash sha256 0 10000
 trace pause
 trace stats
+trace calls 1000000 1000000
+trace bootstage
+trace write hostfs - ${trace_file}
 reset
 END
 }
@@ -52,13 +56,45 @@ check_results() {
 	if [ "${counts}" != "1 1 0 1 " ]; then
 		fail "trace collection error: ${counts}"
 	fi
+
+	if ! grep -q "bytes written to ${trace_file}" ${tmp}; then
+		fail "trace write error"
+	fi
+}
+
+# Convert the trace file to JSON and check that it has the expected events
+check_json() {
+	echo "Check JSON"
+
+	./${OUTPUT_DIR}/tools/proftool -m ${OUTPUT_DIR}/System.map \
+		-p ${trace_file} dump-json >${json} || fail "proftool error"
+
+	python - ${json} <<END || fail "JSON error"
+import json, sys
+
+events = json.load(open(sys.argv[1]))['traceEvents']
+names = {}
+for event in events:
+    names.setdefault((event['ph'], event['tid']), set()).add(event['name'])
+
+# Function entry/exit, boot stages and init functions, with the init
+# functions found in System.map from their offset
+for ph, tid, name in (('B', 1, 'hash_command'), ('E', 1, 'hash_command'),
+                      ('i', 2, 'board_init_f'), ('i', 2, 'board_init_r'),
+                      ('X', 3, 'initr_dm')):
+    if name not in names.get((ph, tid), ()):
+        sys.exit("No '%s' event for %s on track %d" % (ph, name, tid))
+END
 }
 
 echo "Simple trace test / sanity check using sandbox"
 echo
 tmp="$(tempfile)"
-build_uboot "${TRACE_OPT}"
+trace_file="$(tempfile)"
+json="$(tempfile)"
+build_uboot "${TRACE_OPT}" "${TRACE_CONFIG}"
 run_trace >${tmp}
 check_results ${tmp}
-rm ${tmp}
+check_json
+rm ${tmp} ${trace_file} ${json}
 echo "Test passed"
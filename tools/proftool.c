@@ -55,6 +55,8 @@ struct func_info *func_list;
 int func_count;
 struct trace_call *call_list;
 int call_count;
+struct trace_output_stage *stage_list;
+int stage_count;
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 unsigned long text_offset;		/* text address of first function */
 
@@ -85,6 +87,7 @@ static void usage(void)
 		"\n"
 		"Commands\n"
 		"   dump-ftrace\t\tDump out textual data in ftrace format\n"
+		"   dump-json\t\tDump out Chrome Trace Event JSON\n"
 		"\n"
 		"Options:\n"
 		"   -m <map>\tSpecify Systen.map file\n"
@@ -226,6 +229,29 @@ static int read_calls(FILE *fin, int count)
 	return 0;
 }
 
+static int read_stages(FILE *fin, int count)
+{
+	struct trace_output_stage *stage;
+	int i;
+
+	notice("stage count: %d\n", count);
+	stage_list = realloc(stage_list,
+			     (stage_count + count) * sizeof(*stage_list));
+	if (!stage_list) {
+		error("Cannot allocate stage_list\n");
+		return -1;
+	}
+
+	stage = stage_list + stage_count;
+	for (i = 0; i < count; i++, stage++) {
+		if (read_data(fin, stage, sizeof(*stage)))
+			return 1;
+		stage->name[TRACE_STAGE_NAME_LEN - 1] = '\0';
+		stage_count++;
+	}
+	return 0;
+}
+
 static int read_profile(FILE *fin, int *not_found)
 {
 	struct trace_output_hdr hdr;
@@ -249,6 +275,11 @@ static int read_profile(FILE *fin, int *not_found)
 			if (read_calls(fin, hdr.rec_count))
 				return 1;
 			break;
+
+		case TRACE_CHUNK_STAGES:
+			if (read_stages(fin, hdr.rec_count))
+				return 1;
+			break;
 		}
 	}
 	return 0;
@@ -532,6 +563,125 @@ static int make_ftrace(void)
 	return 0;
 }
 
+/* Thread IDs used to show each kind of record on its own track */
+enum {
+	JSON_TID_FUNCS		= 1,
+	JSON_TID_STAGES,
+	JSON_TID_INITCALLS,
+};
+
+static void json_string(const char *str)
+{
+	putchar('"');
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			printf("\\%c", *str);
+		else if ((unsigned char)*str < ' ')
+			printf("\\u%04x", *str);
+		else
+			putchar(*str);
+	}
+	putchar('"');
+}
+
+/* Start a new event and write its name, thread and timestamp */
+static void json_event(int *countp, const char *name, const char *phase,
+		       int tid, ulong time)
+{
+	printf("%s\n{\"name\":", (*countp)++ ? "," : "");
+	json_string(name);
+	printf(",\"ph\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%lu", phase,
+	       tid, time);
+}
+
+static void json_thread_name(int *countp, int tid, const char *name)
+{
+	json_event(countp, "thread_name", "M", tid, 0);
+	printf(",\"args\":{\"name\":");
+	json_string(name);
+	printf("}}");
+}
+
+/*
+ * Write out the function trace and bootstage records in the Chrome Trace
+ * Event format, which can be loaded into chrome://tracing, Perfetto or
+ * speedscope, for example. Function calls become begin/end events, so they
+ * show as a flame chart. Boot stages are instant events, init functions and
+ * accumulated stages are complete events, each on their own track.
+ *
+ * Function trace uses timer_get_us() and bootstage uses timer_get_boot_us(),
+ * so the tracks only line up if these share a time base.
+ */
+static int make_json(void)
+{
+	struct trace_output_stage *stage;
+	struct trace_call *call;
+	int missing_count = 0, skip_count = 0;
+	int count = 0;
+	int i;
+
+	printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	json_thread_name(&count, JSON_TID_FUNCS, "functions");
+	json_thread_name(&count, JSON_TID_STAGES, "bootstage");
+	json_thread_name(&count, JSON_TID_INITCALLS, "initcalls");
+
+	for (i = 0, call = call_list; i < call_count; i++, call++) {
+		struct func_info *func = find_func_by_offset(call->func);
+		ulong time = call->flags & FUNCF_TIMESTAMP_MASK;
+
+		if (TRACE_CALL_TYPE(call) != FUNCF_ENTRY &&
+		    TRACE_CALL_TYPE(call) != FUNCF_EXIT)
+			continue;
+		if (!func) {
+			warn("Cannot find function at %lx\n",
+			     text_offset + call->func);
+			missing_count++;
+			continue;
+		}
+		if (!(func->flags & FUNCF_TRACE)) {
+			skip_count++;
+			continue;
+		}
+
+		json_event(&count, func->name,
+			   TRACE_CALL_TYPE(call) == FUNCF_ENTRY ? "B" : "E",
+			   JSON_TID_FUNCS, time);
+		putchar('}');
+	}
+
+	for (i = 0, stage = stage_list; i < stage_count; i++, stage++) {
+		const char *name = stage->name;
+
+		if (stage->flags & TRACE_STAGEF_INITCALL) {
+			struct func_info *func;
+
+			func = find_func_by_offset(stage->func);
+			if (func)
+				name = func->name;
+			json_event(&count, name, "X", JSON_TID_INITCALLS,
+				   stage->start_us);
+			printf(",\"dur\":%u}", stage->time_us);
+		} else if (stage->flags & TRACE_STAGEF_ACCUM) {
+			/* Only the last start time is known */
+			json_event(&count, name, "X", JSON_TID_STAGES,
+				   stage->start_us);
+			printf(",\"dur\":%u,\"args\":{\"accum\":true}}",
+			       stage->time_us);
+		} else {
+			json_event(&count, name, "i", JSON_TID_STAGES,
+				   stage->start_us);
+			printf(",\"s\":\"g\"%s}",
+			       stage->flags & TRACE_STAGEF_ERROR ?
+			       ",\"args\":{\"error\":true}" : "");
+		}
+	}
+	printf("\n]}\n");
+	info("json: %d functions not found, %d excluded\n", missing_count,
+	     skip_count);
+
+	return 0;
+}
+
 static int prof_tool(int argc, char * const argv[],
 		     const char *prof_fname, const char *map_fname,
 		     const char *trace_config_fname)
@@ -552,6 +702,8 @@ static int prof_tool(int argc, char * const argv[],
 
 		if (0 == strcmp(cmd, "dump-ftrace"))
 			err = make_ftrace();
+		else if (0 == strcmp(cmd, "dump-json"))
+			err = make_json();
 		else
 			warn("Unknown command '%s'\n", cmd);
 	}